@@ -2,3 +2,7 @@
 
 option(ENABLE_BENCHMARK "Enable Google Benchmark support" OFF)
 option(ENABLE_SDL3 "Enable SDL3 support" OFF)
+option(BUILD_LOG_DECODER "Build PrintLogDecoder for Tools::BinaryLog files" ON)
+option(ENABLE_PROFILER "Compile PROFILE_ZONE / PROFILE_FUNCTION zones into the build" ON)
+set(LOG_MIN_LEVEL "Debug" CACHE STRING "Minimum log level compiled into Tools::Print")
+set_property(CACHE LOG_MIN_LEVEL PROPERTY STRINGS Debug Normal Warning Error Off)
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstddef>
+
 namespace BaseLib::Memory{
 
 struct IMemory{
@@ -9,4 +11,6 @@ struct IMemory{
 	virtual void Deallocate(void* ptr) = 0;
 };
 
+inline IMemory::~IMemory() = default;
+
 }
\ No newline at end of file
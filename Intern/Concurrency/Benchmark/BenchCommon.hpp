@@ -0,0 +1,55 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <benchmark/benchmark.h>
+
+namespace Concurrency::Bench{
+/*
+ * @function: 记录每次操作的耗时并在结束时输出分位数
+ * @note: 每个基准线程一份, 只在各自线程上写; 为降低计时开销只采样每 kSampleEvery 次操作
+ */
+class LatencyRecorder{
+public:
+    static constexpr uint32_t kSampleEvery = 16;
+    using Clock = std::chrono::steady_clock;
+
+    explicit LatencyRecorder(size_t reserve = 1 << 16){
+        samples.reserve(reserve);
+    }
+
+    template <typename Fn>
+    void Measure(Fn&& fn){
+        if (++counter % kSampleEvery != 0) {
+            fn();
+            return ;
+        }
+        const auto begin = Clock::now();
+        fn();
+        const auto end = Clock::now();
+        samples.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count());
+    }
+
+    /*
+     * 输出到 state.counters; 计数器在线程间求和, 所以先除以同角色的线程数 roleThreads 得到平均值
+     */
+    void Report(benchmark::State& state, const char* prefix = "", int roleThreads = 1){
+        if (samples.empty()) return ;
+        std::sort(samples.begin(), samples.end());
+        auto at = [this, roleThreads](double q){
+            const size_t index = std::min(samples.size() - 1, static_cast<size_t>(q * samples.size()));
+            return static_cast<double>(samples[index]) / roleThreads;
+        };
+        state.counters[std::string(prefix) + "p50_ns"] = at(0.50);
+        state.counters[std::string(prefix) + "p99_ns"] = at(0.99);
+    }
+
+private:
+    std::vector<int64_t> samples;
+    uint32_t counter { 0 };
+};
+
+}
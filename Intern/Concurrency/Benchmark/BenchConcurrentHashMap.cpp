@@ -0,0 +1,90 @@
+#include <cstdint>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+#include <benchmark/benchmark.h>
+
+#include "../ConcurrentHashMap.hpp"
+#include "BenchCommon.hpp"
+
+using namespace Concurrency;
+
+namespace {
+/* 对照组: std::unordered_map + std::shared_mutex */
+class SharedMutexMap{
+public:
+    explicit SharedMutexMap(size_t capacity){
+        map.reserve(capacity);
+    }
+
+    bool Find(uint64_t key, uint64_t& out) const{
+        std::shared_lock<std::shared_mutex> lock(mutex);
+        auto it = map.find(key);
+        if (it == map.end()) return false;
+        out = it->second;
+        return true;
+    }
+    void InsertOrAssign(uint64_t key, uint64_t value){
+        std::unique_lock<std::shared_mutex> lock(mutex);
+        map.insert_or_assign(key, value);
+    }
+    bool Erase(uint64_t key){
+        std::unique_lock<std::shared_mutex> lock(mutex);
+        return map.erase(key) != 0;
+    }
+
+private:
+    std::unordered_map<uint64_t, uint64_t> map;
+    mutable std::shared_mutex mutex;
+};
+
+constexpr uint64_t kKeySpace = 1 << 16;
+
+uint64_t NextRandom(uint64_t& state) noexcept{
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+}
+
+/*
+ * range(0): 写操作占比 (%), 写操作中一半覆盖一半删除, 保持表的大小大致稳定
+ * 表预先填充一半的键空间, 所有线程共享
+ */
+template <typename Map>
+void BM_Mixed(benchmark::State& state){
+    static Map map(kKeySpace);
+    static const bool prefilled = []{
+        for (uint64_t key = 0; key < kKeySpace; key += 2) map.InsertOrAssign(key, key);
+        return true;
+    }();
+    benchmark::DoNotOptimize(prefilled);
+    const uint64_t writePercent = static_cast<uint64_t>(state.range(0));
+
+    Bench::LatencyRecorder recorder;
+    uint64_t random = 0x9E3779B97F4A7C15ull * (state.thread_index() + 1);
+    uint64_t hits = 0;
+    for (auto _ : state) {
+        const uint64_t r = NextRandom(random);
+        const uint64_t key = r % kKeySpace;
+        if ((r >> 32) % 100 >= writePercent) {
+            recorder.Measure([&]{
+                uint64_t value;
+                hits += map.Find(key, value);
+            });
+        } else if ((r >> 40) & 1) {
+            recorder.Measure([&]{ map.InsertOrAssign(key, r); });
+        } else {
+            recorder.Measure([&]{ map.Erase(key); });
+        }
+    }
+    benchmark::DoNotOptimize(hits);
+    state.SetItemsProcessed(state.iterations());
+    recorder.Report(state, "", state.threads());
+}
+}
+
+BENCHMARK_TEMPLATE(BM_Mixed, ConcurrentHashMap<uint64_t, uint64_t>)
+    ->ArgName("write%")->Arg(5)->Arg(50)->ThreadRange(1, 8)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_Mixed, SharedMutexMap)
+    ->ArgName("write%")->Arg(5)->Arg(50)->ThreadRange(1, 8)->UseRealTime();
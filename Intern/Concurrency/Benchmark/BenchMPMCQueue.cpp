@@ -0,0 +1,92 @@
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <queue>
+#include <benchmark/benchmark.h>
+
+#include "../MPMCQueue.hpp"
+#include "BenchCommon.hpp"
+
+using namespace Concurrency;
+
+namespace {
+/* 对照组: std::mutex + std::queue 的有界阻塞队列 */
+template <typename Ty>
+class MutexQueue{
+public:
+    explicit MutexQueue(size_t capacity)
+        : capacity(capacity) {}
+
+    void Push(Ty value){
+        std::unique_lock<std::mutex> lock(mutex);
+        notFull.wait(lock, [this]{ return queue.size() < capacity; });
+        queue.push(std::move(value));
+        lock.unlock();
+        notEmpty.notify_one();
+    }
+    void Pop(Ty& out){
+        std::unique_lock<std::mutex> lock(mutex);
+        notEmpty.wait(lock, [this]{ return !queue.empty(); });
+        out = std::move(queue.front());
+        queue.pop();
+        lock.unlock();
+        notFull.notify_one();
+    }
+
+private:
+    std::queue<Ty> queue;
+    std::mutex mutex;
+    std::condition_variable notFull;
+    std::condition_variable notEmpty;
+    size_t capacity;
+};
+
+constexpr size_t kCapacity = 1024;
+
+/*
+ * range(0) 个生产者, range(1) 个消费者, 线程数为两者之和
+ * 每次迭代生产者 Push range(1) 个, 消费者 Pop range(0) 个, 保证总量相等
+ */
+template <typename Queue>
+void BM_ProducerConsumer(benchmark::State& state){
+    /* 所有线程共享同一个队列; 每轮结束时 Push 与 Pop 数量相等, 队列必然为空, 所以不需要重建 */
+    static Queue queue(kCapacity);
+    const int producers = static_cast<int>(state.range(0));
+    const int consumers = static_cast<int>(state.range(1));
+    const bool isProducer = state.thread_index() < producers;
+    const int opsPerIter = isProducer ? consumers : producers;
+
+    Bench::LatencyRecorder recorder;
+    uint64_t value = 0;
+    for (auto _ : state) {
+        for (int i = 0; i < opsPerIter; ++i) {
+            if (isProducer) {
+                recorder.Measure([&]{ queue.Push(value++); });
+            } else {
+                recorder.Measure([&]{ queue.Pop(value); });
+            }
+        }
+    }
+    benchmark::DoNotOptimize(value);
+    state.SetItemsProcessed(state.iterations() * opsPerIter);
+    recorder.Report(state, isProducer ? "push_" : "pop_", isProducer ? producers : consumers);
+}
+
+/* Threads() 会与所有 Args 做笛卡尔积, 所以每种比例单独注册 */
+template <typename Queue>
+void RegisterProducerConsumer(const char* name){
+    for (auto [p, c] : { std::pair{1, 1}, {2, 2}, {4, 4}, {1, 3}, {3, 1}, {1, 7}, {7, 1} }) {
+        benchmark::RegisterBenchmark(name, BM_ProducerConsumer<Queue>)
+            ->Args({ p, c })
+            ->ArgNames({ "producers", "consumers" })
+            ->Threads(p + c)
+            ->UseRealTime();
+    }
+}
+
+const bool registered = [] {
+    RegisterProducerConsumer<MPMCQueue<uint64_t>>("BM_ProducerConsumer<MPMCQueue>");
+    RegisterProducerConsumer<MutexQueue<uint64_t>>("BM_ProducerConsumer<MutexQueue>");
+    return true;
+}();
+}
@@ -0,0 +1,83 @@
+#include <cstdint>
+#include <vector>
+#include <benchmark/benchmark.h>
+
+#include "../SPSCRing.hpp"
+
+using namespace Concurrency;
+
+namespace {
+constexpr size_t kCapacity = 1 << 16;
+
+/* 线程 0 为生产者, 线程 1 为消费者; 每次迭代双方各传输 range(0) 个元素 */
+void BM_SPSCRing_Single(benchmark::State& state){
+    static SPSCRing<uint64_t> ring(kCapacity);
+    const size_t batch = static_cast<size_t>(state.range(0));
+    uint64_t value = 0;
+    for (auto _ : state) {
+        if (state.thread_index() == 0) {
+            for (size_t i = 0; i < batch; ++i) {
+                while (!ring.TryPush(value)) CpuRelax();
+                ++value;
+            }
+        } else {
+            for (size_t i = 0; i < batch; ++i) {
+                while (!ring.TryPop(value)) CpuRelax();
+            }
+        }
+    }
+    benchmark::DoNotOptimize(value);
+    state.SetItemsProcessed(state.iterations() * batch);
+}
+
+void BM_SPSCRing_Batch(benchmark::State& state){
+    static SPSCRing<uint64_t> ring(kCapacity);
+    const size_t batch = static_cast<size_t>(state.range(0));
+    std::vector<uint64_t> buffer(batch);
+    for (auto _ : state) {
+        size_t done = 0;
+        if (state.thread_index() == 0) {
+            while (done < batch) {
+                done += ring.PushN(buffer.data() + done, batch - done);
+            }
+        } else {
+            while (done < batch) {
+                done += ring.PopN(buffer.data() + done, batch - done);
+            }
+        }
+    }
+    benchmark::DoNotOptimize(buffer.data());
+    state.SetItemsProcessed(state.iterations() * batch);
+}
+
+/* 零拷贝: 直接在环上读写, 不经过中间缓冲 */
+void BM_SPSCRing_ZeroCopy(benchmark::State& state){
+    static SPSCRing<uint64_t> ring(kCapacity);
+    const size_t batch = static_cast<size_t>(state.range(0));
+    uint64_t sum = 0;
+    for (auto _ : state) {
+        size_t done = 0;
+        if (state.thread_index() == 0) {
+            while (done < batch) {
+                auto span = ring.PrepareWrite(batch - done);
+                for (size_t i = 0; i < span.size(); ++i) span[i] = done + i;
+                ring.CommitWrite(span.size());
+                done += span.size();
+            }
+        } else {
+            while (done < batch) {
+                auto span = ring.PeekRead(batch - done);
+                for (uint64_t v : span) sum += v;
+                ring.CommitRead(span.size());
+                done += span.size();
+            }
+        }
+    }
+    benchmark::DoNotOptimize(sum);
+    state.SetItemsProcessed(state.iterations() * batch);
+}
+}
+
+BENCHMARK(BM_SPSCRing_Single)->Arg(1)->Arg(64)->Threads(2)->UseRealTime();
+BENCHMARK(BM_SPSCRing_Batch)->Arg(16)->Arg(256)->Arg(4096)->Threads(2)->UseRealTime();
+BENCHMARK(BM_SPSCRing_ZeroCopy)->Arg(256)->Arg(4096)->Threads(2)->UseRealTime();
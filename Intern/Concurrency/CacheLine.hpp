@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstddef>
+#if defined(_MSC_VER)
+    #include <intrin.h>
+#endif
+
+namespace Concurrency{
+/* 不使用 std::hardware_destructive_interference_size, 它在不同编译选项下会变化 (GCC 会给出 ABI 警告) */
+inline constexpr size_t kCacheLineSize = 64;
+
+/*
+ * @function: 自旋等待时的 CPU 提示, 降低超线程争用与功耗
+ */
+inline void CpuRelax() noexcept{
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    _mm_pause();
+#elif defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield" ::: "memory");
+#endif
+}
+
+/*
+ * @function: 独占一条缓存行的值, 避免伪共享
+ */
+template <typename Ty>
+struct alignas(kCacheLineSize) CacheAligned{
+    Ty value {};
+};
+
+}
@@ -0,0 +1,157 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace Concurrency{
+
+class OperationCancelled : public std::exception{
+public:
+    const char* what() const noexcept override{
+        return "operation cancelled";
+    }
+};
+
+namespace Detail{
+struct CancellationState{
+    std::atomic<bool> requested { false };
+    std::mutex mutex;
+    std::vector<std::pair<uint64_t, std::function<void()>>> callbacks;
+    uint64_t nextId { 1 };
+    /* 正在执行的回调及执行它的线程, 注销时据此等待回调结束 */
+    uint64_t runningId { 0 };
+    std::thread::id runningThread;
+    std::condition_variable finished;
+};
+}
+
+class CancellationRegistration;
+
+/*
+ * @function: 取消令牌, 由 CancellationSource 发出, 可以随意拷贝
+ * @note: 默认构造的令牌永远不会被取消
+ */
+class CancellationToken{
+public:
+    CancellationToken() noexcept = default;
+
+    bool CanBeCancelled() const noexcept{
+        return state != nullptr;
+    }
+    bool IsCancellationRequested() const noexcept{
+        return state && state->requested.load(std::memory_order_acquire);
+    }
+    void ThrowIfCancellationRequested() const{
+        if (IsCancellationRequested()) {
+            throw OperationCancelled{};
+        }
+    }
+
+private:
+    friend class CancellationSource;
+    friend class CancellationRegistration;
+    explicit CancellationToken(std::shared_ptr<Detail::CancellationState> state) noexcept
+        : state(std::move(state)) {}
+
+    std::shared_ptr<Detail::CancellationState> state { nullptr };
+};
+
+class CancellationSource{
+public:
+    CancellationSource()
+        : state(std::make_shared<Detail::CancellationState>()) {}
+
+    CancellationToken GetToken() const noexcept{
+        return CancellationToken{ state };
+    }
+    bool IsCancellationRequested() const noexcept{
+        return state->requested.load(std::memory_order_acquire);
+    }
+
+    /*
+     * 只有第一次调用会执行回调, 回调在调用线程上按注册顺序逐个执行 (不持有锁)
+     * 执行中的回调被注销时, CancellationRegistration 的析构函数会等待它结束
+     * 回调抛出异常时其余回调照常执行, 全部结束后重新抛出第一个异常
+     */
+    void RequestCancellation(){
+        if (state->requested.exchange(true, std::memory_order_acq_rel)) return ;
+        std::exception_ptr error;
+        std::unique_lock<std::mutex> lock(state->mutex);
+        while (!state->callbacks.empty()) {
+            std::function<void()> callback = std::move(state->callbacks.front().second);
+            state->runningId = state->callbacks.front().first;
+            state->runningThread = std::this_thread::get_id();
+            state->callbacks.erase(state->callbacks.begin());
+            lock.unlock();
+            /* 异常不能跳过下面的复位, 否则等待这个回调的注销会永远阻塞 */
+            try {
+                callback();
+            } catch (...) {
+                if (!error) error = std::current_exception();
+            }
+            callback = nullptr;
+            lock.lock();
+            state->runningId = 0;
+            state->finished.notify_all();
+        }
+        lock.unlock();
+        if (error) std::rethrow_exception(error);
+    }
+
+private:
+    std::shared_ptr<Detail::CancellationState> state;
+};
+
+/*
+ * @function: RAII 的取消回调注册, 析构时注销
+ * @note: 如果注册时已经取消, 回调会在构造函数中立即执行
+ * @note: 析构时回调正在其他线程上执行, 则等待它结束; 在回调自身中析构 (同一线程) 时不等待
+ */
+class CancellationRegistration{
+public:
+    CancellationRegistration(const CancellationToken& token, std::function<void()> callback)
+        : state(token.state){
+        if (!state) return ;
+        {
+            std::lock_guard<std::mutex> lock(state->mutex);
+            if (!state->requested.load(std::memory_order_acquire)) {
+                id = state->nextId++;
+                state->callbacks.emplace_back(id, std::move(callback));
+                return ;
+            }
+        }
+        callback();
+    }
+
+    CancellationRegistration(const CancellationRegistration&) = delete;
+    CancellationRegistration& operator=(const CancellationRegistration&) = delete;
+
+    ~CancellationRegistration(){
+        if (!state || id == 0) return ;
+        std::unique_lock<std::mutex> lock(state->mutex);
+        auto& callbacks = state->callbacks;
+        for (auto it = callbacks.begin(); it != callbacks.end(); ++it) {
+            if (it->first == id) {
+                callbacks.erase(it);
+                return ;
+            }
+        }
+        if (state->runningId == id && state->runningThread != std::this_thread::get_id()) {
+            state->finished.wait(lock, [this]{ return state->runningId != id; });
+        }
+    }
+
+private:
+    std::shared_ptr<Detail::CancellationState> state { nullptr };
+    uint64_t id { 0 };
+};
+
+}
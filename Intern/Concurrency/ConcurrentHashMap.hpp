@@ -0,0 +1,430 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <type_traits>
+#include <vector>
+
+#include "CacheLine.hpp"
+
+namespace Concurrency{
+/*
+ * @function: 并发开放寻址哈希表, 用于多线程共享的缓存
+ * @note: 读: 无锁. 每个槽位带一个 seqlock 版本号, 读者在版本号前后一致时才接受读到的键值
+ * @note: 写: 按键的哈希分条加锁 (kStripeCount 把锁), 同一个键的写入互斥; 占用槽位再通过版本号 CAS 抢占
+ * @note: 扩容: 渐进式. 扩容时只在切换表的瞬间短暂持有所有分条锁, 之后每次写操作顺带迁移 kMigrateChunk 个槽位,
+ * @      读者先查旧表再查新表, 不会被阻塞
+ * @note: 键值以定长字的形式内联存放在槽位数组中 (线性探测), 所以 Key/Value 必须是平凡可拷贝的
+ * @note: 被替换下来的旧表保留到析构时才释放 (无锁读者可能仍在访问), 只扩容时其总大小不超过当前表;
+ * @      大量删除导致的重建 (容量不变) 也会留下旧表, 可以在没有并发访问的时间点调用 ReclaimRetired 释放
+ */
+template <typename Key, typename Value, typename Hash = std::hash<Key>, typename KeyEqual = std::equal_to<Key>>
+class ConcurrentHashMap{
+    static_assert(std::is_trivially_copyable_v<Key>, "ConcurrentHashMap requires trivially copyable Key");
+    static_assert(std::is_trivially_copyable_v<Value>, "ConcurrentHashMap requires trivially copyable Value");
+    static_assert(std::is_default_constructible_v<Key> && std::is_default_constructible_v<Value>,
+                  "ConcurrentHashMap requires default constructible Key and Value");
+public:
+    static constexpr size_t kStripeCount = 64;
+    static constexpr size_t kMigrateChunk = 16;
+    static constexpr size_t kMinCapacity = kStripeCount * 8;
+
+    explicit ConcurrentHashMap(size_t capacity = kMinCapacity, Hash hash = Hash{}, KeyEqual equal = KeyEqual{})
+        : hasher(std::move(hash)), equal(std::move(equal)){
+        size_t rounded = kMinCapacity;
+        while (rounded < capacity) rounded <<= 1;
+        tables.push_back(std::make_unique<Table>(rounded));
+        current.store(tables.back().get(), std::memory_order_release);
+    }
+
+    ConcurrentHashMap(const ConcurrentHashMap&) = delete;
+    ConcurrentHashMap& operator=(const ConcurrentHashMap&) = delete;
+
+    /* ------------------------------ 读 ------------------------------ */
+    bool Find(const Key& key, Value& out) const noexcept{
+        const size_t hash = HashOf(key);
+        for (;;) {
+            Table* table = current.load(std::memory_order_acquire);
+            Table* previous = old.load(std::memory_order_acquire);
+            /* 旧表里的 Moved 是迁移中的正常状态: 键总是先写入新表再在旧表标记 Moved, 随后查新表一定能找到 */
+            bool sawMoved = false;
+            if (previous && previous != table) {
+                if (Lookup(*previous, key, hash, out, sawMoved)) return true;
+                sawMoved = false;
+            }
+            if (Lookup(*table, key, hash, out, sawMoved)) return true;
+            /* 当前表里出现 Moved 说明查找期间表被切换过, 键可能刚被迁走, 重来 */
+            if (!sawMoved && current.load(std::memory_order_acquire) == table) return false;
+        }
+    }
+
+    std::optional<Value> Find(const Key& key) const noexcept{
+        Value value;
+        if (Find(key, value)) return value;
+        return std::nullopt;
+    }
+
+    bool Contains(const Key& key) const noexcept{
+        Value value;
+        return Find(key, value);
+    }
+
+    size_t Size() const noexcept{
+        return count.load(std::memory_order_relaxed);
+    }
+    size_t Capacity() const noexcept{
+        return current.load(std::memory_order_acquire)->capacity;
+    }
+
+    /* ------------------------------ 写 ------------------------------ */
+    /* 键不存在时插入, 返回是否插入 */
+    bool Insert(const Key& key, const Value& value){
+        return Write(key, &value, WriteMode::InsertOnly);
+    }
+    /* 插入或覆盖, 返回是否为新插入 */
+    bool InsertOrAssign(const Key& key, const Value& value){
+        return Write(key, &value, WriteMode::Assign);
+    }
+    /* 返回是否删除了元素 */
+    bool Erase(const Key& key){
+        return Write(key, nullptr, WriteMode::Erase);
+    }
+
+    /*
+     * @function: 释放已退役的旧表
+     * @note: 调用时不能有其他线程正在访问这个表 (例如在帧末的同步点)
+     */
+    void ReclaimRetired(){
+        std::lock_guard<std::mutex> resizeLock(resizeMutex);
+        if (old.load(std::memory_order_acquire)) return;
+        Table* table = current.load(std::memory_order_acquire);
+        std::erase_if(tables, [table](const std::unique_ptr<Table>& t){ return t.get() != table; });
+    }
+
+private:
+    enum SlotState : uint32_t { Empty = 0, Full = 1, Tombstone = 2, Moved = 3 };
+    enum class WriteMode { InsertOnly, Assign, Erase };
+
+    static constexpr size_t kKeyWords = (sizeof(Key) + 7) / 8;
+    static constexpr size_t kValueWords = (sizeof(Value) + 7) / 8;
+
+    /*
+     * 槽位内容全部通过原子字访问, seqlock 的读写竞争在语言层面也是良定义的
+     * version 为奇数表示正在写
+     */
+    struct Slot{
+        std::atomic<uint32_t> version { 0 };
+        std::atomic<uint32_t> state { Empty };
+        uint64_t key[kKeyWords] {};
+        uint64_t value[kValueWords] {};
+    };
+
+    struct Table{
+        explicit Table(size_t capacity)
+            : slots(std::make_unique<Slot[]>(capacity)), capacity(capacity), mask(capacity - 1) {}
+
+        std::unique_ptr<Slot[]> slots;
+        size_t capacity;
+        size_t mask;
+        std::atomic<size_t> used { 0 };     /* Full + Tombstone, 决定何时扩容 */
+        /* 作为旧表被迁移时的进度; 跟随表本身, 读到过期旧表指针的帮手只会在那张表上领到越界的块 */
+        alignas(kCacheLineSize) std::atomic<size_t> migrateCursor { 0 };
+        std::atomic<size_t> migrated { 0 };
+    };
+
+    struct alignas(kCacheLineSize) Stripe{
+        std::mutex mutex;
+    };
+
+    enum class PutResult { Inserted, Assigned, Present, TableFull };
+
+    /* --------------------------- 字拷贝 --------------------------- */
+    template <typename Ty, size_t Words>
+    static void StoreWords(uint64_t (&words)[Words], const Ty& object) noexcept{
+        uint64_t buffer[Words] {};
+        std::memcpy(buffer, &object, sizeof(Ty));
+        for (size_t i = 0; i < Words; ++i) {
+            std::atomic_ref<uint64_t>(words[i]).store(buffer[i], std::memory_order_relaxed);
+        }
+    }
+    template <typename Ty, size_t Words>
+    static Ty LoadWords(const uint64_t (&words)[Words]) noexcept{
+        uint64_t buffer[Words];
+        for (size_t i = 0; i < Words; ++i) {
+            buffer[i] = std::atomic_ref<uint64_t>(const_cast<uint64_t&>(words[i])).load(std::memory_order_relaxed);
+        }
+        Ty object;
+        std::memcpy(&object, buffer, sizeof(Ty));
+        return object;
+    }
+
+    size_t HashOf(const Key& key) const noexcept{
+        /* 混合一下, std::hash<int> 往往是恒等映射 */
+        uint64_t h = static_cast<uint64_t>(hasher(key));
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdull;
+        h ^= h >> 33;
+        return static_cast<size_t>(h);
+    }
+    Stripe& StripeOf(size_t hash) const noexcept{
+        return stripes[(hash >> 7) & (kStripeCount - 1)];
+    }
+
+    /* --------------------------- 读路径 --------------------------- */
+    bool Lookup(const Table& table, const Key& key, size_t hash, Value& out, bool& sawMoved) const noexcept{
+        for (size_t probe = 0; probe < table.capacity; ++probe) {
+            const Slot& slot = table.slots[(hash + probe) & table.mask];
+            for (;;) {
+                const uint32_t before = slot.version.load(std::memory_order_acquire);
+                if (before & 1u) {
+                    CpuRelax();
+                    continue;
+                }
+                const uint32_t state = slot.state.load(std::memory_order_relaxed);
+                bool match = false;
+                Value value;
+                if (state == Full) {
+                    match = equal(LoadWords<Key>(slot.key), key);
+                    if (match) value = LoadWords<Value>(slot.value);
+                }
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (slot.version.load(std::memory_order_relaxed) != before) continue;
+
+                if (state == Empty) return false;
+                if (state == Moved) sawMoved = true;
+                if (match) {
+                    out = value;
+                    return true;
+                }
+                break;
+            }
+        }
+        return false;
+    }
+
+    /* --------------------------- 写路径 --------------------------- */
+    /* 取槽位的一致快照 (state + key), 返回对应的偶数版本号 */
+    static uint32_t Snapshot(const Slot& slot, uint32_t& state, Key& key) noexcept{
+        for (;;) {
+            const uint32_t before = slot.version.load(std::memory_order_acquire);
+            if (before & 1u) {
+                CpuRelax();
+                continue;
+            }
+            state = slot.state.load(std::memory_order_relaxed);
+            if (state == Full) key = LoadWords<Key>(slot.key);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.version.load(std::memory_order_relaxed) == before) return before;
+        }
+    }
+    /* 只有版本号仍等于快照时才能锁住槽位, 保证写入基于的快照没有过期 */
+    static bool TryLockSlot(Slot& slot, uint32_t version) noexcept{
+        if (!slot.version.compare_exchange_strong(version, version + 1, std::memory_order_relaxed)) return false;
+        std::atomic_thread_fence(std::memory_order_release);
+        return true;
+    }
+    static void UnlockSlot(Slot& slot, uint32_t version) noexcept{
+        slot.version.store(version + 2, std::memory_order_release);
+    }
+
+    /*
+     * @note: 调用方必须持有 key 对应的分条锁
+     * @note: 只有持有同一把分条锁的线程会写入这个 key, 所以 "链上没有这个 key" 的结论在锁内一直成立;
+     * @      其他分条的写者只会抢占空槽/墓碑, 抢占冲突时重新探测
+     */
+    PutResult Put(Table& table, const Key& key, size_t hash, const Value& value, WriteMode mode) noexcept{
+        for (;;) {
+            Slot* target = nullptr;
+            uint32_t targetVersion = 0;
+            uint32_t targetState = Empty;
+            for (size_t probe = 0; probe < table.capacity; ++probe) {
+                Slot& slot = table.slots[(hash + probe) & table.mask];
+                uint32_t state;
+                Key slotKey;
+                const uint32_t version = Snapshot(slot, state, slotKey);
+                if (state == Full) {
+                    if (equal(slotKey, key)) {
+                        target = &slot;
+                        targetVersion = version;
+                        targetState = Full;
+                        break;
+                    }
+                } else if (state == Tombstone || state == Empty) {
+                    if (!target) {
+                        target = &slot;
+                        targetVersion = version;
+                        targetState = state;
+                    }
+                    if (state == Empty) break;
+                }
+            }
+
+            if (!target) return PutResult::TableFull;
+            if (targetState == Full && mode == WriteMode::InsertOnly) return PutResult::Present;
+            if (!TryLockSlot(*target, targetVersion)) continue;
+
+            if (targetState != Full) StoreWords(target->key, key);
+            StoreWords(target->value, value);
+            target->state.store(Full, std::memory_order_relaxed);
+            UnlockSlot(*target, targetVersion);
+            if (targetState == Full) return PutResult::Assigned;
+            if (targetState == Empty) table.used.fetch_add(1, std::memory_order_relaxed);
+            return PutResult::Inserted;
+        }
+    }
+
+    /* 调用方持有 key 对应的分条锁; 把 key 标记为 toState (Tombstone / Moved), 可选地取出旧值 */
+    static bool Remove(Table& table, const Key& key, size_t hash, SlotState toState,
+                       Value* removed, const KeyEqual& equal) noexcept{
+        for (size_t probe = 0; probe < table.capacity;) {
+            Slot& slot = table.slots[(hash + probe) & table.mask];
+            uint32_t state;
+            Key slotKey;
+            const uint32_t version = Snapshot(slot, state, slotKey);
+            if (state == Empty) return false;
+            if (state != Full || !equal(slotKey, key)) {
+                ++probe;
+                continue;
+            }
+            /* 其他分条的写者不会碰这个槽位, CAS 失败时重新取快照 */
+            if (!TryLockSlot(slot, version)) continue;
+            if (removed) *removed = LoadWords<Value>(slot.value);
+            slot.state.store(toState, std::memory_order_relaxed);
+            UnlockSlot(slot, version);
+            return true;
+        }
+        return false;
+    }
+
+    /*
+     * 调用方持有 key 对应的分条锁; key 在旧表中时把它搬到新表, 返回是否搬了
+     * 先写入新表, 再把旧表的槽位标记为 Moved: 无锁读者先查旧表再查新表, 不会在两张表里都找不到这个 key
+     */
+    bool MoveKey(Table& from, Table& to, const Key& key, size_t hash) noexcept{
+        Value value;
+        bool sawMoved = false;
+        /* 持有分条锁, 没有其他写者会改这个 key, 读到的值在搬运期间保持不变 */
+        if (!Lookup(from, key, hash, value, sawMoved)) return false;
+        if (Put(to, key, hash, value, WriteMode::Assign) == PutResult::TableFull) {
+            /* 不会发生: 迁移完成之前新表的占用率不超过一半 */
+            std::terminate();
+        }
+        Remove(from, key, hash, Moved, nullptr, equal);
+        return true;
+    }
+
+    bool Write(const Key& key, const Value* value, WriteMode mode){
+        const size_t hash = HashOf(key);
+        /* 迁移与扩容都会获取其他分条锁, 必须在持有自己的分条锁之前完成 */
+        HelpMigrate();
+        for (;;) {
+            Table* table = current.load(std::memory_order_acquire);
+            if (mode != WriteMode::Erase && NeedsGrow(*table)) {
+                Grow(table);
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(StripeOf(hash).mutex);
+            /* 拿到锁之后再读一次: 切换表时会持有全部分条锁 */
+            table = current.load(std::memory_order_acquire);
+            Table* previous = old.load(std::memory_order_acquire);
+
+            /* 这个 key 还在旧表里时先把它搬过来, 保证新表中的写入总是最新的 */
+            const bool movedFromOld = previous && MoveKey(*previous, *table, key, hash);
+
+            if (mode == WriteMode::Erase) {
+                const bool erased = Remove(*table, key, hash, Tombstone, nullptr, equal);
+                if (erased) count.fetch_sub(1, std::memory_order_relaxed);
+                return erased;
+            }
+
+            const PutResult result = Put(*table, key, hash, *value, mode);
+            if (result == PutResult::TableFull) {
+                lock.unlock();
+                Grow(table);
+                continue;
+            }
+            if (result == PutResult::Inserted && !movedFromOld) {
+                count.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
+            return false;
+        }
+    }
+
+    bool NeedsGrow(const Table& table) const noexcept{
+        return table.used.load(std::memory_order_relaxed) * 4 >= table.capacity * 3;
+    }
+
+    /* --------------------------- 扩容 --------------------------- */
+    void Grow(Table* observed){
+        for (;;) {
+            /* 上一轮迁移没结束时先帮忙做完 */
+            while (old.load(std::memory_order_acquire)) {
+                HelpMigrate();
+                CpuRelax();
+            }
+            std::lock_guard<std::mutex> resizeLock(resizeMutex);
+            if (old.load(std::memory_order_acquire)) continue;
+            Table* table = current.load(std::memory_order_acquire);
+            if (table != observed) return;      /* 别人已经扩过了 */
+
+            /* 占用主要来自墓碑时按原容量重建, 只清理墓碑 */
+            const bool mostlyTombstones = count.load(std::memory_order_relaxed) * 2 < table->capacity;
+            tables.push_back(std::make_unique<Table>(mostlyTombstones ? table->capacity : table->capacity * 2));
+            Table* next = tables.back().get();
+
+            /* 短暂持有全部分条锁, 保证没有写者还在往旧表里写 */
+            for (Stripe& stripe : stripes) stripe.mutex.lock();
+            old.store(table, std::memory_order_release);
+            current.store(next, std::memory_order_release);
+            for (Stripe& stripe : stripes) stripe.mutex.unlock();
+            return;
+        }
+    }
+
+    /* 领取一块旧表槽位并迁移到新表; 调用时不能持有任何分条锁 */
+    void HelpMigrate(){
+        Table* previous = old.load(std::memory_order_acquire);
+        if (!previous) return;
+        const size_t begin = previous->migrateCursor.fetch_add(kMigrateChunk, std::memory_order_relaxed);
+        if (begin >= previous->capacity) return;
+        const size_t end = std::min(begin + kMigrateChunk, previous->capacity);
+
+        for (size_t i = begin; i < end; ++i) {
+            Slot& slot = previous->slots[i];
+            if (slot.state.load(std::memory_order_acquire) != Full) continue;
+            const Key key = LoadWords<Key>(slot.key);
+            const size_t hash = HashOf(key);
+            std::lock_guard<std::mutex> lock(StripeOf(hash).mutex);
+            /* 加锁后重新确认: 可能已经被该 key 的写者搬走或删除 */
+            MoveKey(*previous, *current.load(std::memory_order_acquire), key, hash);
+        }
+
+        if (previous->migrated.fetch_add(end - begin, std::memory_order_acq_rel) + (end - begin) == previous->capacity) {
+            std::lock_guard<std::mutex> resizeLock(resizeMutex);
+            Table* expected = previous;
+            old.compare_exchange_strong(expected, nullptr, std::memory_order_acq_rel);
+        }
+    }
+
+private:
+    Hash hasher;
+    KeyEqual equal;
+    std::atomic<Table*> current { nullptr };
+    std::atomic<Table*> old { nullptr };
+    alignas(kCacheLineSize) std::atomic<size_t> count { 0 };
+    mutable Stripe stripes[kStripeCount];
+    std::mutex resizeMutex;
+    std::vector<std::unique_ptr<Table>> tables;    /* 包括已退役的旧表 */
+};
+
+}
@@ -0,0 +1,207 @@
+#pragma once
+
+#include <condition_variable>
+#include <coroutine>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace Concurrency{
+/*
+ * @function: executor 上的一个待执行单元
+ * @note: 协程恢复只存 handle, 函数指针 + 上下文的形式也不分配内存; 只有 std::function 可能分配
+ */
+struct Job{
+    using Callback = void (*)(void*);
+
+    Job() = default;
+    Job(std::coroutine_handle<> handle) noexcept
+        : handle(handle) {}
+    Job(Callback callback, void* context) noexcept
+        : callback(callback), context(context) {}
+    Job(std::function<void()> fn) noexcept
+        : fn(std::move(fn)) {}
+
+    void operator()(){
+        if (handle) {
+            handle.resume();
+        } else if (callback) {
+            callback(context);
+        } else if (fn) {
+            fn();
+        }
+    }
+
+    std::coroutine_handle<> handle { nullptr };
+    Callback callback { nullptr };
+    void* context { nullptr };
+    std::function<void()> fn { nullptr };
+};
+
+class IExecutor;
+
+/*
+ * @function: co_await executor.Schedule() 之后, 协程在该 executor 上继续执行
+ */
+struct ScheduleAwaiter{
+    IExecutor& executor;
+
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(std::coroutine_handle<> handle);
+    void await_resume() const noexcept {}
+};
+
+/*
+ * @function: 执行器接口, 线程池 / IO 线程 / 渲染线程都实现它
+ */
+class IExecutor{
+public:
+    virtual ~IExecutor() = default;
+    virtual void Post(Job job) = 0;
+
+    ScheduleAwaiter Schedule() noexcept{
+        return ScheduleAwaiter{ *this };
+    }
+};
+
+inline void ScheduleAwaiter::await_suspend(std::coroutine_handle<> handle){
+    executor.Post(Job{ handle });
+}
+
+/*
+ * @function: 直接在调用线程上执行
+ */
+class InlineExecutor final : public IExecutor{
+public:
+    void Post(Job job) override{
+        job();
+    }
+};
+
+/*
+ * @function: 固定线程数的线程池
+ * @note: 析构时会把队列中剩余的任务执行完再退出
+ */
+class ThreadPool final : public IExecutor{
+public:
+    explicit ThreadPool(size_t threadCount = std::thread::hardware_concurrency()){
+        if (threadCount == 0) threadCount = 1;
+        workers.reserve(threadCount);
+        for (size_t i = 0; i < threadCount; ++i) {
+            workers.emplace_back([this]{ WorkerLoop(); });
+        }
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    ~ThreadPool(){
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        cv.notify_all();
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    }
+
+    void Post(Job job) override{
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            jobs.push_back(std::move(job));
+        }
+        cv.notify_one();
+    }
+
+    size_t GetThreadCount() const noexcept{
+        return workers.size();
+    }
+
+private:
+    void WorkerLoop(){
+        for (;;) {
+            Job job;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                cv.wait(lock, [this]{ return stopping || !jobs.empty(); });
+                if (jobs.empty()) return ;
+                job = std::move(jobs.front());
+                jobs.pop_front();
+            }
+            job();
+        }
+    }
+
+private:
+    std::vector<std::thread> workers;
+    std::deque<Job> jobs;
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool stopping { false };
+};
+
+/*
+ * @function: 由某个已有线程 (IO 线程, 渲染线程) 驱动的执行器
+ * @note: 渲染线程每帧调用 RunPending(); 专用线程可以调用 Run() 直到 Stop()
+ */
+class LoopExecutor final : public IExecutor{
+public:
+    void Post(Job job) override{
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            jobs.push_back(std::move(job));
+        }
+        cv.notify_one();
+    }
+
+    /* 执行当前已经入队的任务, 返回执行的数量 */
+    size_t RunPending(){
+        std::deque<Job> pending;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            pending.swap(jobs);
+        }
+        for (auto& job : pending) {
+            job();
+        }
+        return pending.size();
+    }
+
+    void Run(){
+        for (;;) {
+            Job job;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                cv.wait(lock, [this]{ return stopping || !jobs.empty(); });
+                if (jobs.empty()) {
+                    stopping = false;
+                    return ;
+                }
+                job = std::move(jobs.front());
+                jobs.pop_front();
+            }
+            job();
+        }
+    }
+
+    void Stop(){
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        cv.notify_all();
+    }
+
+private:
+    std::deque<Job> jobs;
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool stopping { false };
+};
+
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+
+namespace Concurrency{
+/*
+ * @function: 协程帧的池化分配器
+ * @note: 帧大小按 kGranularity 划分 size class, 每个线程维护一组空闲链表, 命中时分配只是一次链表弹出
+ * @note: 协程经常在别的 executor 上结束, 此时帧归还到释放线程的链表 (不做跨线程归还)
+ * @note: 超过 kClassCount 的大帧或链表已满时直接走全局 operator new/delete
+ */
+class FramePool{
+public:
+    static constexpr size_t kGranularity = 64;
+    static constexpr size_t kClassCount = 16;           /* 池化的最大帧为 1KB */
+    static constexpr size_t kMaxCachedPerClass = 256;
+
+    static void* Allocate(size_t size){
+        const size_t total = size + sizeof(Header);
+        const size_t sizeClass = (total - 1) / kGranularity;
+        if (sizeClass >= kClassCount){
+            Header* header = static_cast<Header*>(::operator new(total));
+            header->sizeClass = kUnpooled;
+            return header + 1;
+        }
+
+        Cache& cache = LocalCache();
+        Header* header = nullptr;
+        if (cache.alive && cache.heads[sizeClass]){
+            FreeNode* node = cache.heads[sizeClass];
+            cache.heads[sizeClass] = node->next;
+            --cache.counts[sizeClass];
+            header = reinterpret_cast<Header*>(node);
+        } else {
+            header = static_cast<Header*>(::operator new((sizeClass + 1) * kGranularity));
+        }
+        header->sizeClass = sizeClass;
+        return header + 1;
+    }
+
+    static void Deallocate(void* ptr) noexcept{
+        if (!ptr) return ;
+        Header* header = static_cast<Header*>(ptr) - 1;
+        const size_t sizeClass = header->sizeClass;
+        if (sizeClass == kUnpooled){
+            ::operator delete(header);
+            return ;
+        }
+
+        Cache& cache = LocalCache();
+        if (!cache.alive || cache.counts[sizeClass] >= kMaxCachedPerClass){
+            ::operator delete(header);
+            return ;
+        }
+        FreeNode* node = reinterpret_cast<FreeNode*>(header);
+        node->next = cache.heads[sizeClass];
+        cache.heads[sizeClass] = node;
+        ++cache.counts[sizeClass];
+    }
+
+private:
+    static constexpr size_t kUnpooled = ~size_t(0);
+
+    /* 头部按 max_align_t 对齐, 保证返回给协程帧的地址满足默认 new 对齐 */
+    struct alignas(alignof(std::max_align_t)) Header{
+        size_t sizeClass;
+    };
+    struct FreeNode{
+        FreeNode* next;
+    };
+
+    struct Cache{
+        FreeNode* heads[kClassCount] {};
+        size_t counts[kClassCount] {};
+        bool alive { true };
+
+        ~Cache(){
+            alive = false;
+            for (FreeNode*& head : heads){
+                while (head){
+                    FreeNode* next = head->next;
+                    ::operator delete(head);
+                    head = next;
+                }
+            }
+        }
+    };
+
+    static Cache& LocalCache() noexcept{
+        thread_local Cache cache;
+        return cache;
+    }
+};
+
+/*
+ * @function: promise 继承它即可让协程帧从 FramePool 分配
+ */
+struct PooledFrame{
+    static void* operator new(size_t size){
+        return FramePool::Allocate(size);
+    }
+    static void operator delete(void* ptr) noexcept{
+        FramePool::Deallocate(ptr);
+    }
+};
+
+}
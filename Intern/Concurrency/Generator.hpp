@@ -0,0 +1,138 @@
+#pragma once
+
+#include <coroutine>
+#include <exception>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+#include "FramePool.hpp"
+
+namespace Concurrency{
+/*
+ * @function: 同步生成器, 每次迭代恢复协程直到下一个 co_yield
+ * @Usage:
+    Generator<int> Range(int n){
+        for (int i = 0; i < n; ++i) co_yield i;
+    }
+    for (int i : Range(10)) { ... }
+ */
+template <typename Ty>
+class Generator{
+public:
+    using value_type = std::remove_cvref_t<Ty>;
+    using reference = std::conditional_t<std::is_reference_v<Ty>, Ty, const value_type&>;
+    using pointer = std::add_pointer_t<reference>;
+
+    struct promise_type : PooledFrame{
+        Generator get_return_object() noexcept{
+            return Generator{ std::coroutine_handle<promise_type>::from_promise(*this) };
+        }
+        std::suspend_always initial_suspend() const noexcept { return {}; }
+        std::suspend_always final_suspend() const noexcept { return {}; }
+
+        /* co_yield 的对象活到下一次恢复之前, 所以直接存地址即可 */
+        std::suspend_always yield_value(reference value) noexcept{
+            current = std::addressof(value);
+            return {};
+        }
+        std::suspend_always yield_value(value_type&& value) noexcept
+            requires (!std::is_reference_v<Ty>){
+            current = std::addressof(value);
+            return {};
+        }
+        void return_void() const noexcept {}
+        void unhandled_exception() noexcept{
+            exception = std::current_exception();
+        }
+        /* 生成器内部禁止 co_await */
+        template <typename Uty>
+        std::suspend_never await_transform(Uty&&) = delete;
+
+        void Rethrow(){
+            if (exception) {
+                std::rethrow_exception(std::exchange(exception, nullptr));
+            }
+        }
+
+        pointer current { nullptr };
+        std::exception_ptr exception { nullptr };
+    };
+
+    using handle_type = std::coroutine_handle<promise_type>;
+
+    struct Sentinel {};
+
+    class Iterator{
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using difference_type = std::ptrdiff_t;
+        using value_type = Generator::value_type;
+        using reference = Generator::reference;
+        using pointer = Generator::pointer;
+
+        Iterator() noexcept = default;
+        explicit Iterator(handle_type handle) noexcept
+            : handle(handle) {}
+
+        Iterator& operator++(){
+            handle.resume();
+            if (handle.done()) {
+                handle.promise().Rethrow();
+            }
+            return *this;
+        }
+        void operator++(int){
+            ++*this;
+        }
+        reference operator*() const noexcept{
+            return static_cast<reference>(*handle.promise().current);
+        }
+        pointer operator->() const noexcept{
+            return handle.promise().current;
+        }
+        friend bool operator==(const Iterator& it, Sentinel) noexcept{
+            return !it.handle || it.handle.done();
+        }
+
+    private:
+        handle_type handle { nullptr };
+    };
+
+public:
+    Generator() noexcept = default;
+    explicit Generator(handle_type handle) noexcept
+        : handle(handle) {}
+    Generator(Generator&& other) noexcept
+        : handle(std::exchange(other.handle, nullptr)) {}
+    Generator& operator=(Generator&& other) noexcept{
+        if (this != &other) {
+            if (handle) handle.destroy();
+            handle = std::exchange(other.handle, nullptr);
+        }
+        return *this;
+    }
+    Generator(const Generator&) = delete;
+    Generator& operator=(const Generator&) = delete;
+    ~Generator(){
+        if (handle) handle.destroy();
+    }
+
+    Iterator begin(){
+        if (!handle) return Iterator{};
+        handle.resume();
+        if (handle.done()) {
+            handle.promise().Rethrow();
+        }
+        return Iterator{ handle };
+    }
+    Sentinel end() const noexcept{
+        return {};
+    }
+
+private:
+    handle_type handle { nullptr };
+};
+
+}
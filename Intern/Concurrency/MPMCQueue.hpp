@@ -0,0 +1,195 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "CacheLine.hpp"
+
+namespace Concurrency{
+/*
+ * @function: 有界多生产者多消费者无锁队列 (Dmitry Vyukov 的数组队列)
+ * @note: 每个槽位有一个序号 sequence:
+ * @      sequence == pos       槽位空闲, 可以写入第 pos 个元素
+ * @      sequence == pos + 1   槽位已写入, 可以读出第 pos 个元素
+ * @      读出后 sequence = pos + capacity, 等待下一圈写入
+ * @note: 容量会向上取整为 2 的幂
+ * @note: Push / Pop 是阻塞版本: 先自旋 kSpinCount 次, 然后通过 std::atomic::wait 睡眠 (Linux 上是 futex)
+ */
+template <typename Ty>
+class MPMCQueue{
+public:
+    static constexpr int kSpinCount = 128;
+
+    explicit MPMCQueue(size_t capacity){
+        if (capacity < 2) capacity = 2;
+        size_t rounded = 1;
+        while (rounded < capacity) rounded <<= 1;
+        mask = rounded - 1;
+        cells = std::make_unique<Cell[]>(rounded);
+        for (size_t i = 0; i < rounded; ++i) {
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    MPMCQueue(const MPMCQueue&) = delete;
+    MPMCQueue& operator=(const MPMCQueue&) = delete;
+
+    ~MPMCQueue(){
+        if constexpr (!std::is_trivially_destructible_v<Ty>) {
+            for (Slot slot = AcquireForPop(); slot.cell; slot = AcquireForPop()) {
+                ReleaseAfterPop(slot);
+            }
+        }
+    }
+
+    template <typename... Args>
+    bool TryEmplace(Args&&... args) noexcept(std::is_nothrow_constructible_v<Ty, Args...>){
+        Cell* cell = nullptr;
+        size_t pos = enqueuePos.value.load(std::memory_order_relaxed);
+        for (;;) {
+            cell = &cells[pos & mask];
+            const size_t seq = cell->sequence.load(std::memory_order_acquire);
+            const intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (enqueuePos.value.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+            } else if (diff < 0) {
+                return false;   /* 满了 */
+            } else {
+                pos = enqueuePos.value.load(std::memory_order_relaxed);
+            }
+        }
+        ::new (static_cast<void*>(cell->storage)) Ty(std::forward<Args>(args)...);
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        NotifyIfWaiting(popWaiters, notEmptyEpoch);
+        return true;
+    }
+
+    bool TryPush(const Ty& value) noexcept(std::is_nothrow_copy_constructible_v<Ty>){
+        return TryEmplace(value);
+    }
+    bool TryPush(Ty&& value) noexcept(std::is_nothrow_move_constructible_v<Ty>){
+        return TryEmplace(std::move(value));
+    }
+
+    bool TryPop(Ty& out) noexcept(std::is_nothrow_move_assignable_v<Ty>){
+        Slot slot = AcquireForPop();
+        if (!slot.cell) return false;
+        out = std::move(*slot.cell->Value());
+        ReleaseAfterPop(slot);
+        return true;
+    }
+
+    template <typename Uty>
+    void Push(Uty&& value){
+        for (int i = 0; i < kSpinCount; ++i) {
+            if (TryPush(std::forward<Uty>(value))) return ;
+            CpuRelax();
+        }
+        for (;;) {
+            pushWaiters.value.fetch_add(1, std::memory_order_seq_cst);
+            const uint32_t epoch = notFullEpoch.value.load(std::memory_order_seq_cst);
+            if (TryPush(std::forward<Uty>(value))) {
+                pushWaiters.value.fetch_sub(1, std::memory_order_relaxed);
+                return ;
+            }
+            notFullEpoch.value.wait(epoch, std::memory_order_seq_cst);
+            pushWaiters.value.fetch_sub(1, std::memory_order_relaxed);
+        }
+    }
+
+    void Pop(Ty& out){
+        for (int i = 0; i < kSpinCount; ++i) {
+            if (TryPop(out)) return ;
+            CpuRelax();
+        }
+        for (;;) {
+            popWaiters.value.fetch_add(1, std::memory_order_seq_cst);
+            const uint32_t epoch = notEmptyEpoch.value.load(std::memory_order_seq_cst);
+            if (TryPop(out)) {
+                popWaiters.value.fetch_sub(1, std::memory_order_relaxed);
+                return ;
+            }
+            notEmptyEpoch.value.wait(epoch, std::memory_order_seq_cst);
+            popWaiters.value.fetch_sub(1, std::memory_order_relaxed);
+        }
+    }
+
+    size_t Capacity() const noexcept{
+        return mask + 1;
+    }
+    /* 并发修改时只是近似值 */
+    size_t ApproxSize() const noexcept{
+        const size_t tail = enqueuePos.value.load(std::memory_order_relaxed);
+        const size_t head = dequeuePos.value.load(std::memory_order_relaxed);
+        return tail > head ? tail - head : 0;
+    }
+
+private:
+    struct alignas(kCacheLineSize) Cell{
+        std::atomic<size_t> sequence { 0 };
+        alignas(Ty) unsigned char storage[sizeof(Ty)];
+
+        Ty* Value() noexcept{
+            return std::launder(reinterpret_cast<Ty*>(storage));
+        }
+    };
+
+    struct Slot{
+        Cell* cell;
+        size_t pos;
+    };
+
+    Slot AcquireForPop() noexcept{
+        size_t pos = dequeuePos.value.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell* cell = &cells[pos & mask];
+            const size_t seq = cell->sequence.load(std::memory_order_acquire);
+            const intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+            if (diff == 0) {
+                if (dequeuePos.value.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    return Slot{ cell, pos };
+                }
+            } else if (diff < 0) {
+                return Slot{ nullptr, 0 };   /* 空的 */
+            } else {
+                pos = dequeuePos.value.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    void ReleaseAfterPop(Slot slot) noexcept{
+        slot.cell->Value()->~Ty();
+        slot.cell->sequence.store(slot.pos + mask + 1, std::memory_order_release);
+        NotifyIfWaiting(pushWaiters, notFullEpoch);
+    }
+
+    /*
+     * 与等待方的 fetch_add(waiters) -> load(epoch) -> Try* 构成 Dekker 式的配对:
+     * 要么这里看到 waiters > 0 去推进 epoch, 要么等待方的 Try* 看到了这次修改
+     */
+    static void NotifyIfWaiting(CacheAligned<std::atomic<uint32_t>>& waiters,
+                                CacheAligned<std::atomic<uint32_t>>& epoch) noexcept{
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (waiters.value.load(std::memory_order_relaxed) != 0) {
+            epoch.value.fetch_add(1, std::memory_order_seq_cst);
+            epoch.value.notify_all();
+        }
+    }
+
+private:
+    CacheAligned<std::atomic<size_t>> enqueuePos;
+    CacheAligned<std::atomic<size_t>> dequeuePos;
+    CacheAligned<std::atomic<uint32_t>> pushWaiters;
+    CacheAligned<std::atomic<uint32_t>> popWaiters;
+    CacheAligned<std::atomic<uint32_t>> notFullEpoch;
+    CacheAligned<std::atomic<uint32_t>> notEmptyEpoch;
+    std::unique_ptr<Cell[]> cells;
+    size_t mask { 0 };
+};
+
+}
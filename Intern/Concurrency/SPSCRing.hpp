@@ -0,0 +1,199 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <type_traits>
+#include <utility>
+
+#include "CacheLine.hpp"
+
+namespace Concurrency{
+/*
+ * @function: SPSC 环形缓冲区的共享控制块
+ * @note: tail 只由生产者写, head 只由消费者写, 分别独占一条缓存行
+ * @note: 只包含无锁原子量, 可以直接放进进程间共享内存
+ */
+struct SPSCRingControl{
+    alignas(kCacheLineSize) std::atomic<uint64_t> tail { 0 };
+    alignas(kCacheLineSize) std::atomic<uint64_t> head { 0 };
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "SPSCRing requires lock-free 64-bit atomics");
+
+namespace Detail{
+/*
+ * @function: 在给定控制块和缓冲区上操作的 SPSC 环
+ * @note: 生产者与消费者各自缓存对端的下标, 只有在看起来满/空时才去读对端的缓存行
+ * @note: 所有操作都是 wait-free 的: 不重试, 不等待
+ */
+template <typename Ty>
+class SPSCRingView{
+public:
+    SPSCRingView() noexcept = default;
+    SPSCRingView(SPSCRingControl* control, Ty* buffer, size_t capacity) noexcept
+        : control(control), buffer(buffer), mask(capacity - 1){
+        producer.tail = control->tail.load(std::memory_order_relaxed);
+        producer.headCache = control->head.load(std::memory_order_acquire);
+        consumer.head = control->head.load(std::memory_order_relaxed);
+        consumer.tailCache = control->tail.load(std::memory_order_acquire);
+    }
+
+    /* ----------------------------- 生产者 ----------------------------- */
+    template <typename Uty>
+    bool TryPush(Uty&& value) noexcept(std::is_nothrow_assignable_v<Ty&, Uty>){
+        if (producer.tail - producer.headCache > mask) {
+            producer.headCache = control->head.load(std::memory_order_acquire);
+            if (producer.tail - producer.headCache > mask) return false;
+        }
+        buffer[producer.tail & mask] = std::forward<Uty>(value);
+        control->tail.store(++producer.tail, std::memory_order_release);
+        return true;
+    }
+
+    /* 返回实际写入的数量 */
+    size_t PushN(const Ty* data, size_t count){
+        size_t pushed = 0;
+        while (pushed < count) {
+            std::span<Ty> span = PrepareWrite(count - pushed);
+            if (span.empty()) break;
+            std::copy_n(data + pushed, span.size(), span.begin());
+            pushed += span.size();
+            producer.tail += span.size();
+        }
+        if (pushed) {
+            control->tail.store(producer.tail, std::memory_order_release);
+        }
+        return pushed;
+    }
+
+    /*
+     * @function: 零拷贝写入, 返回从当前写位置开始的连续可写区域 (不会跨过环的末尾)
+     * @note: 填好数据后调用 CommitWrite(n) 发布前 n 个
+     */
+    std::span<Ty> PrepareWrite(size_t maxCount) noexcept{
+        size_t free = Capacity() - (producer.tail - producer.headCache);
+        if (free < maxCount) {
+            producer.headCache = control->head.load(std::memory_order_acquire);
+            free = Capacity() - (producer.tail - producer.headCache);
+        }
+        const size_t offset = producer.tail & mask;
+        const size_t count = std::min({ maxCount, free, Capacity() - offset });
+        return std::span<Ty>(buffer + offset, count);
+    }
+    void CommitWrite(size_t count) noexcept{
+        producer.tail += count;
+        control->tail.store(producer.tail, std::memory_order_release);
+    }
+
+    /* ----------------------------- 消费者 ----------------------------- */
+    bool TryPop(Ty& out) noexcept(std::is_nothrow_move_assignable_v<Ty>){
+        if (consumer.head == consumer.tailCache) {
+            consumer.tailCache = control->tail.load(std::memory_order_acquire);
+            if (consumer.head == consumer.tailCache) return false;
+        }
+        out = std::move(buffer[consumer.head & mask]);
+        control->head.store(++consumer.head, std::memory_order_release);
+        return true;
+    }
+
+    /* 返回实际读出的数量 */
+    size_t PopN(Ty* out, size_t count){
+        size_t popped = 0;
+        while (popped < count) {
+            std::span<const Ty> span = PeekRead(count - popped);
+            if (span.empty()) break;
+            std::copy_n(span.begin(), span.size(), out + popped);
+            popped += span.size();
+            consumer.head += span.size();
+        }
+        if (popped) {
+            control->head.store(consumer.head, std::memory_order_release);
+        }
+        return popped;
+    }
+
+    /*
+     * @function: 零拷贝读取, 返回从当前读位置开始的连续可读区域 (不会跨过环的末尾)
+     * @note: 处理完后调用 CommitRead(n) 释放前 n 个
+     */
+    std::span<const Ty> PeekRead(size_t maxCount) noexcept{
+        size_t available = consumer.tailCache - consumer.head;
+        if (available < maxCount) {
+            consumer.tailCache = control->tail.load(std::memory_order_acquire);
+            available = consumer.tailCache - consumer.head;
+        }
+        const size_t offset = consumer.head & mask;
+        const size_t count = std::min({ maxCount, available, Capacity() - offset });
+        return std::span<const Ty>(buffer + offset, count);
+    }
+    void CommitRead(size_t count) noexcept{
+        consumer.head += count;
+        control->head.store(consumer.head, std::memory_order_release);
+    }
+
+    /* ----------------------------- 通用 ----------------------------- */
+    size_t Capacity() const noexcept{
+        return mask + 1;
+    }
+    /* 任意线程调用时只是近似值 */
+    size_t ApproxSize() const noexcept{
+        const uint64_t tail = control->tail.load(std::memory_order_acquire);
+        const uint64_t head = control->head.load(std::memory_order_acquire);
+        return static_cast<size_t>(tail - head);
+    }
+
+private:
+    SPSCRingControl* control { nullptr };
+    Ty* buffer { nullptr };
+    size_t mask { 0 };
+    /* 生产者与消费者的本地状态分开放, 避免两个线程写同一条缓存行 */
+    struct alignas(kCacheLineSize) ProducerState{
+        uint64_t tail { 0 };
+        uint64_t headCache { 0 };
+    } producer;
+    struct alignas(kCacheLineSize) ConsumerState{
+        uint64_t head { 0 };
+        uint64_t tailCache { 0 };
+    } consumer;
+};
+
+inline size_t RoundUpPowerOfTwo(size_t value) noexcept{
+    size_t rounded = 1;
+    while (rounded < value) rounded <<= 1;
+    return rounded;
+}
+}
+
+/*
+ * @function: 单生产者单消费者的 wait-free 环形缓冲区
+ * @note: 只能有一个线程调用生产者接口 (TryPush / PushN / PrepareWrite / CommitWrite),
+ * @      一个线程调用消费者接口 (TryPop / PopN / PeekRead / CommitRead)
+ * @note: 容量会向上取整为 2 的幂; 进程间版本见 SharedSPSCRing.hpp
+ */
+template <typename Ty>
+class SPSCRing : public Detail::SPSCRingView<Ty>{
+public:
+    static_assert(std::is_default_constructible_v<Ty>, "SPSCRing requires default constructible Ty");
+
+    explicit SPSCRing(size_t capacity)
+        : SPSCRing(std::make_unique<SPSCRingControl>(),
+                   std::make_unique<Ty[]>(Detail::RoundUpPowerOfTwo(std::max<size_t>(capacity, 2))),
+                   Detail::RoundUpPowerOfTwo(std::max<size_t>(capacity, 2))) {}
+
+    SPSCRing(const SPSCRing&) = delete;
+    SPSCRing& operator=(const SPSCRing&) = delete;
+
+private:
+    SPSCRing(std::unique_ptr<SPSCRingControl> control, std::unique_ptr<Ty[]> storage, size_t capacity)
+        : Detail::SPSCRingView<Ty>(control.get(), storage.get(), capacity),
+          control(std::move(control)), storage(std::move(storage)) {}
+
+    std::unique_ptr<SPSCRingControl> control;
+    std::unique_ptr<Ty[]> storage;
+};
+
+}
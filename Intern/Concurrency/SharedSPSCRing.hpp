@@ -0,0 +1,161 @@
+#pragma once
+
+#if defined(__linux__) || defined(__APPLE__)
+
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "SPSCRing.hpp"
+
+namespace Concurrency{
+/*
+ * @function: 放在 POSIX 共享内存里的 SPSC 环, 用于同一台机器上两个进程之间传输数据
+ * @note: 共享内存布局: [Header | 元素数组], Header 中包含 SPSCRingControl
+ * @note: Ty 必须是平凡可拷贝的, 且不能包含指针 (两个进程的地址空间不同)
+ * @Usage:
+    // 进程 A (生产者)
+    auto ring = SharedSPSCRing<Packet>::Create("/capture", 1 << 16);
+    ring.TryPush(packet);
+    // 进程 B (消费者)
+    auto ring = SharedSPSCRing<Packet>::Open("/capture");
+    ring.PeekRead(64); ... ring.CommitRead(n);
+    SharedSPSCRing<Packet>::Unlink("/capture");
+ */
+template <typename Ty>
+class SharedSPSCRing : public Detail::SPSCRingView<Ty>{
+public:
+    static_assert(std::is_trivially_copyable_v<Ty>, "SharedSPSCRing requires trivially copyable Ty");
+
+    /* 创建新的共享内存段, 同名段已存在时抛出 std::system_error */
+    static SharedSPSCRing Create(const std::string& name, size_t capacity){
+        capacity = Detail::RoundUpPowerOfTwo(capacity < 2 ? 2 : capacity);
+        const size_t bytes = BufferOffset() + capacity * sizeof(Ty);
+
+        const int fd = ::shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+        if (fd < 0) {
+            throw std::system_error(errno, std::generic_category(), "shm_open " + name);
+        }
+        if (::ftruncate(fd, static_cast<off_t>(bytes)) != 0) {
+            const int error = errno;
+            ::close(fd);
+            ::shm_unlink(name.c_str());
+            throw std::system_error(error, std::generic_category(), "ftruncate " + name);
+        }
+        void* mapping = Map(fd, bytes, name);
+
+        Header* header = ::new (mapping) Header{};
+        header->capacity = capacity;
+        header->elementSize = sizeof(Ty);
+        header->magic.store(kMagic, std::memory_order_release);
+        return SharedSPSCRing(mapping, bytes);
+    }
+
+    /* 打开已经由另一个进程 Create 好的段 */
+    static SharedSPSCRing Open(const std::string& name){
+        const int fd = ::shm_open(name.c_str(), O_RDWR, 0600);
+        if (fd < 0) {
+            throw std::system_error(errno, std::generic_category(), "shm_open " + name);
+        }
+        struct stat info {};
+        if (::fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < BufferOffset()) {
+            ::close(fd);
+            throw std::runtime_error("SharedSPSCRing " + name + " is not initialized");
+        }
+        const size_t bytes = static_cast<size_t>(info.st_size);
+        void* mapping = Map(fd, bytes, name);
+
+        Header* header = static_cast<Header*>(mapping);
+        if (header->magic.load(std::memory_order_acquire) != kMagic ||
+            header->elementSize != sizeof(Ty) ||
+            BufferOffset() + header->capacity * sizeof(Ty) > bytes) {
+            ::munmap(mapping, bytes);
+            throw std::runtime_error("SharedSPSCRing " + name + " has an incompatible layout");
+        }
+        return SharedSPSCRing(mapping, bytes);
+    }
+
+    /* 删除名字, 已经映射的进程不受影响 */
+    static void Unlink(const std::string& name) noexcept{
+        ::shm_unlink(name.c_str());
+    }
+
+    SharedSPSCRing(SharedSPSCRing&& other) noexcept
+        : Detail::SPSCRingView<Ty>(std::move(other)),
+          mapping(std::exchange(other.mapping, nullptr)),
+          bytes(std::exchange(other.bytes, 0)) {}
+    SharedSPSCRing& operator=(SharedSPSCRing&& other) noexcept{
+        if (this != &other) {
+            Unmap();
+            Detail::SPSCRingView<Ty>::operator=(std::move(other));
+            mapping = std::exchange(other.mapping, nullptr);
+            bytes = std::exchange(other.bytes, 0);
+        }
+        return *this;
+    }
+    SharedSPSCRing(const SharedSPSCRing&) = delete;
+    SharedSPSCRing& operator=(const SharedSPSCRing&) = delete;
+
+    ~SharedSPSCRing(){
+        Unmap();
+    }
+
+private:
+    static constexpr uint64_t kMagic = 0x53505343'52494E47ull; /* "SPSCRING" */
+
+    struct Header{
+        std::atomic<uint64_t> magic { 0 };
+        uint64_t capacity { 0 };
+        uint64_t elementSize { 0 };
+        SPSCRingControl control;
+    };
+
+    static constexpr size_t BufferOffset() noexcept{
+        constexpr size_t align = alignof(Ty) > kCacheLineSize ? alignof(Ty) : kCacheLineSize;
+        return (sizeof(Header) + align - 1) / align * align;
+    }
+
+    static void* Map(int fd, size_t bytes, const std::string& name){
+        void* mapping = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        const int error = errno;
+        ::close(fd);
+        if (mapping == MAP_FAILED) {
+            throw std::system_error(error, std::generic_category(), "mmap " + name);
+        }
+        return mapping;
+    }
+
+    SharedSPSCRing(void* mapping, size_t bytes) noexcept
+        : Detail::SPSCRingView<Ty>(
+            &static_cast<Header*>(mapping)->control,
+            reinterpret_cast<Ty*>(static_cast<unsigned char*>(mapping) + BufferOffset()),
+            static_cast<Header*>(mapping)->capacity),
+          mapping(mapping), bytes(bytes) {}
+
+    void Unmap() noexcept{
+        if (mapping) {
+            ::munmap(mapping, bytes);
+            mapping = nullptr;
+        }
+    }
+
+private:
+    void* mapping { nullptr };
+    size_t bytes { 0 };
+};
+
+}
+
+#endif
@@ -0,0 +1,259 @@
+#pragma once
+
+#include <condition_variable>
+#include <coroutine>
+#include <exception>
+#include <mutex>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+#include "FramePool.hpp"
+
+namespace Concurrency{
+
+template <typename Ty = void>
+class Task;
+
+namespace Detail{
+/*
+ * @function: 协程结果的存储, 值或者异常
+ */
+template <typename Ty>
+class Result{
+public:
+    template <typename Uty>
+    void SetValue(Uty&& value) noexcept(std::is_nothrow_constructible_v<Ty, Uty>){
+        storage.template emplace<1>(std::forward<Uty>(value));
+    }
+    void SetException(std::exception_ptr exception) noexcept{
+        storage.template emplace<2>(std::move(exception));
+    }
+    bool HasResult() const noexcept{
+        return storage.index() != 0;
+    }
+    /* 结果只能取一次 */
+    Ty Get(){
+        if (storage.index() == 2) {
+            std::rethrow_exception(std::get<2>(storage));
+        }
+        return std::move(std::get<1>(storage));
+    }
+private:
+    std::variant<std::monostate, Ty, std::exception_ptr> storage;
+};
+
+template <>
+class Result<void>{
+public:
+    void SetValue() noexcept{
+        hasValue = true;
+    }
+    void SetException(std::exception_ptr exception) noexcept{
+        this->exception = std::move(exception);
+    }
+    bool HasResult() const noexcept{
+        return hasValue || exception;
+    }
+    void Get(){
+        if (exception) {
+            std::rethrow_exception(exception);
+        }
+    }
+private:
+    std::exception_ptr exception { nullptr };
+    bool hasValue { false };
+};
+
+struct PromiseBase : PooledFrame{
+    struct FinalAwaiter{
+        bool await_ready() const noexcept { return false; }
+
+        /* 对称转移回等待者, 避免深递归 */
+        template <typename Promise>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) noexcept{
+            std::coroutine_handle<> continuation = handle.promise().continuation;
+            return continuation ? continuation : std::noop_coroutine();
+        }
+        void await_resume() const noexcept {}
+    };
+
+    std::suspend_always initial_suspend() const noexcept { return {}; }
+    FinalAwaiter final_suspend() const noexcept { return {}; }
+
+    std::coroutine_handle<> continuation { nullptr };
+};
+
+template <typename Ty>
+struct TaskPromise : PromiseBase{
+    Task<Ty> get_return_object() noexcept;
+
+    template <typename Uty>
+    void return_value(Uty&& value){
+        result.SetValue(std::forward<Uty>(value));
+    }
+    void unhandled_exception() noexcept{
+        result.SetException(std::current_exception());
+    }
+
+    Result<Ty> result;
+};
+
+template <>
+struct TaskPromise<void> : PromiseBase{
+    Task<void> get_return_object() noexcept;
+
+    void return_void() noexcept{
+        result.SetValue();
+    }
+    void unhandled_exception() noexcept{
+        result.SetException(std::current_exception());
+    }
+
+    Result<void> result;
+};
+
+/*
+ * @function: 即发即弃的协程, 结束时自己销毁帧
+ * @note: 只在库内部用来驱动 Task (SyncWait / WhenAll / WhenAny)
+ */
+struct DetachedTask{
+    struct promise_type : PooledFrame{
+        DetachedTask get_return_object() const noexcept { return {}; }
+        std::suspend_never initial_suspend() const noexcept { return {}; }
+        std::suspend_never final_suspend() const noexcept { return {}; }
+        void return_void() const noexcept {}
+        void unhandled_exception() const noexcept { std::terminate(); }
+    };
+};
+}
+
+/*
+ * @function: 惰性启动的协程任务, 被 co_await 时才开始执行
+ * @note: 结束时对称转移回等待者; 协程帧从 FramePool 分配
+ * @Usage:
+    Task<int> Load(IExecutor& io){
+        co_await io.Schedule();   // 之后在 io 线程上执行
+        co_return 42;
+    }
+ */
+template <typename Ty>
+class Task{
+public:
+    static_assert(!std::is_reference_v<Ty>, "Task<Ty&> is not supported, pls use Task<Ty*>");
+    using promise_type = Detail::TaskPromise<Ty>;
+    using handle_type = std::coroutine_handle<promise_type>;
+
+    Task() noexcept = default;
+    explicit Task(handle_type handle) noexcept
+        : handle(handle) {}
+    Task(Task&& other) noexcept
+        : handle(std::exchange(other.handle, nullptr)) {}
+    Task& operator=(Task&& other) noexcept{
+        if (this != &other) {
+            Destroy();
+            handle = std::exchange(other.handle, nullptr);
+        }
+        return *this;
+    }
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+    ~Task(){
+        Destroy();
+    }
+
+    bool IsValid() const noexcept{
+        return handle != nullptr;
+    }
+    bool IsReady() const noexcept{
+        return !handle || handle.done();
+    }
+
+    auto operator co_await() noexcept{
+        struct Awaiter{
+            handle_type handle;
+
+            bool await_ready() const noexcept{
+                return !handle || handle.done();
+            }
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<> continuation) noexcept{
+                handle.promise().continuation = continuation;
+                return handle;
+            }
+            Ty await_resume(){
+                return handle.promise().result.Get();
+            }
+        };
+        return Awaiter{ handle };
+    }
+
+private:
+    void Destroy() noexcept{
+        if (handle) {
+            handle.destroy();
+            handle = nullptr;
+        }
+    }
+
+private:
+    handle_type handle { nullptr };
+};
+
+template <typename Ty>
+Task<Ty> Detail::TaskPromise<Ty>::get_return_object() noexcept{
+    return Task<Ty>{ std::coroutine_handle<TaskPromise<Ty>>::from_promise(*this) };
+}
+
+inline Task<void> Detail::TaskPromise<void>::get_return_object() noexcept{
+    return Task<void>{ std::coroutine_handle<TaskPromise<void>>::from_promise(*this) };
+}
+
+namespace Detail{
+class SyncWaitEvent{
+public:
+    /* 持锁 notify, 保证 Wait 返回后 Set 不会再访问本对象 */
+    void Set(){
+        std::lock_guard<std::mutex> lock(mutex);
+        done = true;
+        cv.notify_all();
+    }
+    void Wait(){
+        std::unique_lock<std::mutex> lock(mutex);
+        cv.wait(lock, [this]{ return done; });
+    }
+private:
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool done { false };
+};
+
+template <typename Ty>
+DetachedTask RunAndStore(Task<Ty>& task, Result<Ty>& result, SyncWaitEvent& event){
+    try {
+        if constexpr (std::is_void_v<Ty>) {
+            co_await task;
+            result.SetValue();
+        } else {
+            result.SetValue(co_await task);
+        }
+    } catch (...) {
+        result.SetException(std::current_exception());
+    }
+    event.Set();
+}
+}
+
+/*
+ * @function: 在当前线程阻塞等待一个 Task 完成并取回结果
+ * @note: 只应在协程之外使用 (main, 测试, 线程入口)
+ */
+template <typename Ty>
+Ty SyncWait(Task<Ty> task){
+    Detail::Result<Ty> result;
+    Detail::SyncWaitEvent event;
+    Detail::RunAndStore(task, result, event);
+    event.Wait();
+    return result.Get();
+}
+
+}
@@ -0,0 +1,259 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "CacheLine.hpp"
+#include "Executor.hpp"
+
+namespace Concurrency{
+/*
+ * @function: 可复用的任务依赖图 (DAG), 在 executor 上并行执行
+ * @note: 建图 (AddNode / AddDependency) -> Compile() -> 每帧 Run(executor)
+ * @note: Compile 之后 TaskGraph 自身在 Run 中不分配内存: 就绪计数, 计时记录都是预分配的数组, 投递使用函数指针形式的 Job;
+ * @      executor 的队列是否分配取决于其实现 (ThreadPool 的 std::deque 会按块分配与释放), 节点抛出异常时 exception_ptr 也会分配
+ * @note: 调度策略是关键路径优先: 节点优先级 = 自身开销 + 后继中最大的优先级;
+ * @      一个节点完成时, 优先级最高的就绪后继直接在当前线程上继续执行, 其余按优先级从高到低投递
+ * @note: Run 会阻塞调用线程, 不要在 executor 自己的工作线程上调用 (单线程池会死锁)
+ * @Usage:
+    TaskGraph graph;
+    auto input = graph.AddNode("Input", [&]{ PollInput(); });
+    auto physics = graph.AddNode("Physics", [&]{ StepPhysics(); }, 4.0f);
+    auto anim = graph.AddNode("Animation", [&]{ StepAnimation(); }, 2.0f);
+    auto render = graph.AddNode("Render", [&]{ SubmitFrame(); });
+    graph.AddDependency(input, physics);
+    graph.AddDependency(input, anim);
+    graph.AddDependency(physics, render);
+    graph.AddDependency(anim, render);
+    graph.Compile();
+    while (running) graph.Run(pool);
+ */
+class TaskGraph{
+public:
+    using NodeId = uint32_t;
+    using Clock = std::chrono::steady_clock;
+
+    struct NodeTiming{
+        int64_t startNs { 0 };      /* 相对于本次 Run 开始 */
+        int64_t endNs { 0 };
+        size_t threadId { 0 };      /* std::hash<std::thread::id> */
+    };
+
+    TaskGraph() = default;
+    TaskGraph(const TaskGraph&) = delete;
+    TaskGraph& operator=(const TaskGraph&) = delete;
+
+    /* @param: cost 预估开销 (任意单位), 只用于计算关键路径 */
+    NodeId AddNode(std::string name, std::function<void()> work, float cost = 1.0f){
+        compiled = false;
+        Node node;
+        node.name = std::move(name);
+        node.work = std::move(work);
+        node.cost = cost;
+        nodes.push_back(std::move(node));
+        return static_cast<NodeId>(nodes.size() - 1);
+    }
+
+    /* before 完成之后 after 才能开始 */
+    void AddDependency(NodeId before, NodeId after){
+        if (before >= nodes.size() || after >= nodes.size() || before == after) {
+            throw std::out_of_range("TaskGraph::AddDependency: invalid node id");
+        }
+        compiled = false;
+        nodes[before].successors.push_back(after);
+        ++nodes[after].predecessorCount;
+    }
+
+    /*
+     * @function: 检查是否有环, 计算关键路径优先级, 并分配运行期所需的全部内存
+     * @note: 有环时抛出 std::logic_error
+     */
+    void Compile(){
+        const size_t count = nodes.size();
+        /* Kahn 拓扑排序 */
+        std::vector<uint32_t> indegree(count);
+        std::vector<NodeId> order;
+        order.reserve(count);
+        for (size_t i = 0; i < count; ++i) {
+            indegree[i] = nodes[i].predecessorCount;
+            if (indegree[i] == 0) order.push_back(static_cast<NodeId>(i));
+        }
+        for (size_t head = 0; head < order.size(); ++head) {
+            for (NodeId next : nodes[order[head]].successors) {
+                if (--indegree[next] == 0) order.push_back(next);
+            }
+        }
+        if (order.size() != count) {
+            throw std::logic_error("TaskGraph::Compile: graph contains a cycle");
+        }
+
+        /* 逆拓扑序计算关键路径长度 */
+        for (auto it = order.rbegin(); it != order.rend(); ++it) {
+            Node& node = nodes[*it];
+            float longest = 0.0f;
+            for (NodeId next : node.successors) {
+                longest = std::max(longest, nodes[next].priority);
+            }
+            node.priority = node.cost + longest;
+        }
+        auto byPriority = [this](NodeId lhs, NodeId rhs){
+            return nodes[lhs].priority > nodes[rhs].priority;
+        };
+        roots.clear();
+        for (size_t i = 0; i < count; ++i) {
+            std::sort(nodes[i].successors.begin(), nodes[i].successors.end(), byPriority);
+            nodes[i].graph = this;
+            nodes[i].id = static_cast<NodeId>(i);
+            if (nodes[i].predecessorCount == 0) roots.push_back(static_cast<NodeId>(i));
+        }
+        std::sort(roots.begin(), roots.end(), byPriority);
+
+        remaining = std::make_unique<std::atomic<uint32_t>[]>(count);
+        timings.assign(count, NodeTiming{});
+        compiled = true;
+    }
+
+    /*
+     * @function: 执行整张图并阻塞等待完成
+     * @note: 节点抛出的第一个异常会在所有节点结束后重新抛出, 其余节点照常执行
+     */
+    void Run(IExecutor& executor){
+        if (!compiled) Compile();
+        if (nodes.empty()) return ;
+
+        for (size_t i = 0; i < nodes.size(); ++i) {
+            remaining[i].store(nodes[i].predecessorCount, std::memory_order_relaxed);
+        }
+        pending.store(static_cast<uint32_t>(nodes.size()), std::memory_order_relaxed);
+        failed.store(false, std::memory_order_relaxed);
+        notified.store(false, std::memory_order_relaxed);
+        firstError = nullptr;
+        runStart = Clock::now();
+        this->executor = &executor;
+
+        for (NodeId root : roots) {
+            executor.Post(Job{ &TaskGraph::RunNodeThunk, &nodes[root] });
+        }
+
+        for (uint32_t left = pending.load(std::memory_order_acquire); left != 0;
+             left = pending.load(std::memory_order_acquire)) {
+            pending.wait(left, std::memory_order_acquire);
+        }
+        /* 等最后一个节点的 notify 返回, 之后调用方可以安全地销毁图 */
+        while (!notified.load(std::memory_order_acquire)) {
+            CpuRelax();
+        }
+        if (firstError) {
+            std::rethrow_exception(std::exchange(firstError, nullptr));
+        }
+    }
+
+    size_t NodeCount() const noexcept{
+        return nodes.size();
+    }
+    const std::string& GetName(NodeId id) const{
+        return nodes.at(id).name;
+    }
+    /* 关键路径长度 (含自身), Compile 之后有效 */
+    float GetPriority(NodeId id) const{
+        return nodes.at(id).priority;
+    }
+    /* 最近一次 Run 的计时, 下标即 NodeId */
+    const std::vector<NodeTiming>& GetTimings() const noexcept{
+        return timings;
+    }
+
+    /*
+     * @function: 以 CSV 导出最近一次 Run 的逐节点计时
+     * @format: name,thread,start_us,duration_us,critical_path
+     */
+    void WriteTimings(std::ostream& stream) const{
+        stream << "name,thread,start_us,duration_us,critical_path\n";
+        for (size_t i = 0; i < nodes.size() && i < timings.size(); ++i) {
+            const NodeTiming& t = timings[i];
+            stream << nodes[i].name << ',' << t.threadId << ','
+                   << t.startNs / 1000.0 << ',' << (t.endNs - t.startNs) / 1000.0 << ','
+                   << nodes[i].priority << '\n';
+        }
+    }
+
+private:
+    struct Node{
+        std::string name;
+        std::function<void()> work;
+        float cost { 1.0f };
+        float priority { 0.0f };
+        std::vector<NodeId> successors;     /* Compile 后按优先级降序 */
+        uint32_t predecessorCount { 0 };
+        NodeId id { 0 };
+        TaskGraph* graph { nullptr };
+    };
+
+    static void RunNodeThunk(void* context){
+        Node* node = static_cast<Node*>(context);
+        node->graph->Execute(node);
+    }
+
+    /* 执行节点, 并沿着优先级最高的就绪后继在本线程上继续 */
+    void Execute(Node* node){
+        while (node) {
+            NodeTiming& timing = timings[node->id];
+            timing.threadId = std::hash<std::thread::id>{}(std::this_thread::get_id());
+            timing.startNs = SinceRunStart();
+            try {
+                if (node->work) node->work();
+            } catch (...) {
+                if (!failed.exchange(true, std::memory_order_acq_rel)) {
+                    firstError = std::current_exception();
+                }
+            }
+            timing.endNs = SinceRunStart();
+
+            Node* next = nullptr;
+            for (NodeId successor : node->successors) {
+                if (remaining[successor].fetch_sub(1, std::memory_order_acq_rel) != 1) continue;
+                if (!next) {
+                    next = &nodes[successor];
+                } else {
+                    executor->Post(Job{ &TaskGraph::RunNodeThunk, &nodes[successor] });
+                }
+            }
+            if (pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                pending.notify_all();
+                notified.store(true, std::memory_order_release);
+            }
+            node = next;
+        }
+    }
+
+    int64_t SinceRunStart() const noexcept{
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - runStart).count();
+    }
+
+private:
+    std::vector<Node> nodes;
+    std::vector<NodeId> roots;
+    std::unique_ptr<std::atomic<uint32_t>[]> remaining;
+    std::vector<NodeTiming> timings;
+    std::atomic<uint32_t> pending { 0 };
+    std::atomic<bool> failed { false };
+    std::atomic<bool> notified { false };
+    std::exception_ptr firstError { nullptr };
+    IExecutor* executor { nullptr };
+    Clock::time_point runStart;
+    bool compiled { false };
+};
+
+}
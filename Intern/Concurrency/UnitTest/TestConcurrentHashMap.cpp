@@ -0,0 +1,91 @@
+#include "../ConcurrentHashMap.hpp"
+#include <atomic>
+#include <cstdint>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+using namespace Concurrency;
+
+bool ConcurrentHashMapTest() {
+    bool all_passed = true;
+    std::cout << "Running ConcurrentHashMap Tests...\n";
+
+    // 1. 单线程: 插入, 覆盖, 删除, 扩容后仍能找到所有键
+    {
+        std::cout << "Running ConcurrentHashMap Tests1\n";
+        ConcurrentHashMap<uint64_t, uint64_t> map;
+        constexpr uint64_t kCount = 20000;
+        for (uint64_t i = 0; i < kCount; ++i) map.Insert(i, i * 2);
+        for (uint64_t i = 0; i < kCount; i += 2) map.InsertOrAssign(i, i * 3);
+        for (uint64_t i = 1; i < kCount; i += 4) map.Erase(i);
+        for (uint64_t i = 0; i < kCount; ++i) {
+            const auto value = map.Find(i);
+            const bool erased = i % 4 == 1;
+            const uint64_t expected = i % 2 == 0 ? i * 3 : i * 2;
+            if (erased ? value.has_value() : (!value || *value != expected)) {
+                std::cerr << "key " << i << ": unexpected lookup result\n";
+                all_passed = false;
+                break;
+            }
+        }
+        if (map.Size() != kCount - kCount / 4) {
+            std::cerr << "size " << map.Size() << "\n";
+            all_passed = false;
+        }
+    }
+
+    // 2. 扩容期间的并发查找: 预先插入且从不删除的键任何时候都必须能找到
+    {
+        std::cout << "Running ConcurrentHashMap Tests2\n";
+        constexpr uint64_t kStable = 4096;
+        constexpr uint64_t kPerWriter = 60000;
+        constexpr int kWriters = 2;
+        constexpr int kReaders = 4;
+        for (int round = 0; round < 20 && all_passed; ++round) {
+            ConcurrentHashMap<uint64_t, uint64_t> map;
+            for (uint64_t i = 0; i < kStable; ++i) map.Insert(i, i + 1);
+            std::atomic<bool> done { false };
+            std::atomic<uint64_t> misses { 0 };
+            std::vector<std::thread> threads;
+            for (int r = 0; r < kReaders; ++r) {
+                threads.emplace_back([&, r] {
+                    uint64_t key = static_cast<uint64_t>(r) * 997;
+                    while (!done.load(std::memory_order_relaxed)) {
+                        key = (key + 1) % kStable;
+                        uint64_t value = 0;
+                        if (!map.Find(key, value) || value != key + 1) misses.fetch_add(1, std::memory_order_relaxed);
+                    }
+                });
+            }
+            for (int w = 0; w < kWriters; ++w) {
+                threads.emplace_back([&, w] {
+                    const uint64_t base = kStable + static_cast<uint64_t>(w) * kPerWriter;
+                    for (uint64_t i = 0; i < kPerWriter; ++i) {
+                        map.Insert(base + i, i);
+                        /* 写入稳定键时会把它从旧表搬到新表 */
+                        if (i % 8 == 0) map.InsertOrAssign(i % kStable, i % kStable + 1);
+                    }
+                });
+            }
+            for (int w = 0; w < kWriters; ++w) threads[kReaders + w].join();
+            done = true;
+            for (int r = 0; r < kReaders; ++r) threads[r].join();
+            if (misses.load() != 0) {
+                std::cerr << "round " << round << ": " << misses.load() << " lookups missed a present key during resize\n";
+                all_passed = false;
+            }
+            if (map.Size() != kStable + kWriters * kPerWriter) {
+                std::cerr << "round " << round << ": size " << map.Size() << "\n";
+                all_passed = false;
+            }
+        }
+    }
+
+    if (all_passed) {
+        std::cout << "All ConcurrentHashMap tests passed!\n";
+    } else {
+        std::cout << "Some ConcurrentHashMap tests FAILED!\n";
+    }
+    return all_passed;
+}
@@ -0,0 +1,233 @@
+#include "../Task.hpp"
+#include "../Generator.hpp"
+#include "../Executor.hpp"
+#include "../WhenAll.hpp"
+#include "../CancellationToken.hpp"
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace Concurrency;
+
+bool TaskTest() {
+    bool all_passed = true;
+    std::cout << "Running Task Tests...\n";
+
+    // 1. 基本的 co_return 与嵌套 co_await
+    {
+        std::cout << "Running Task Tests1\n";
+        auto inner = []() -> Task<int> { co_return 20; };
+        auto outer = [inner]() -> Task<int> { co_return co_await inner() + 22; };
+        if (SyncWait(outer()) != 42) {
+            std::cerr << "nested co_await failed\n";
+            all_passed = false;
+        }
+    }
+
+    // 2. 异常穿过 co_await 传播
+    {
+        std::cout << "Running Task Tests2\n";
+        auto thrower = []() -> Task<void> {
+            throw std::runtime_error("boom");
+            co_return;
+        };
+        bool caught = false;
+        try {
+            SyncWait(thrower());
+        } catch (const std::runtime_error&) {
+            caught = true;
+        }
+        if (!caught) {
+            std::cerr << "exception propagation failed\n";
+            all_passed = false;
+        }
+    }
+
+    // 3. Schedule 之后在线程池上恢复
+    {
+        std::cout << "Running Task Tests3\n";
+        ThreadPool pool(2);
+        const auto mainId = std::this_thread::get_id();
+        auto hop = [&pool]() -> Task<std::thread::id> {
+            co_await pool.Schedule();
+            co_return std::this_thread::get_id();
+        };
+        if (SyncWait(hop()) == mainId) {
+            std::cerr << "Schedule did not switch thread\n";
+            all_passed = false;
+        }
+    }
+
+    // 4. LoopExecutor 由驱动线程恢复
+    {
+        std::cout << "Running Task Tests4\n";
+        LoopExecutor loop;
+        std::thread::id loopId;
+        std::thread loopThread([&] { loopId = std::this_thread::get_id(); loop.Run(); });
+        auto hop = [&loop]() -> Task<std::thread::id> {
+            co_await loop.Schedule();
+            co_return std::this_thread::get_id();
+        };
+        const auto resumedId = SyncWait(hop());
+        loop.Stop();
+        loopThread.join();
+        if (resumedId != loopId) {
+            std::cerr << "LoopExecutor resumed on wrong thread\n";
+            all_passed = false;
+        }
+    }
+
+    // 5. WhenAll 在线程池上并发执行大量任务
+    {
+        std::cout << "Running Task Tests5\n";
+        ThreadPool pool(4);
+        auto square = [&pool](int i) -> Task<int> {
+            co_await pool.Schedule();
+            co_return i * i;
+        };
+        std::vector<Task<int>> tasks;
+        for (int i = 0; i < 1000; ++i) {
+            tasks.push_back(square(i));
+        }
+        auto values = SyncWait(WhenAll(std::move(tasks)));
+        bool ok = values.size() == 1000;
+        for (int i = 0; ok && i < 1000; ++i) {
+            ok = values[i] == i * i;
+        }
+        if (!ok) {
+            std::cerr << "WhenAll results mismatch\n";
+            all_passed = false;
+        }
+    }
+
+    // 6. WhenAny 返回最先完成的任务, 并取消其余任务
+    {
+        std::cout << "Running Task Tests6\n";
+        ThreadPool pool(2);
+        CancellationSource source;
+        /* 不捕获: 失败者在 WhenAny 返回之后仍在运行, 不能引用已经销毁的闭包 */
+        auto work = [](ThreadPool& pool, int id, int ms, CancellationToken token) -> Task<int> {
+            co_await pool.Schedule();
+            for (int i = 0; i < ms; ++i) {
+                token.ThrowIfCancellationRequested();
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+            co_return id;
+        };
+        std::vector<Task<int>> tasks;
+        tasks.push_back(work(pool, 0, 500, source.GetToken()));
+        tasks.push_back(work(pool, 1, 1, source.GetToken()));
+        auto [index, value] = SyncWait(WhenAny(std::move(tasks)));
+        source.RequestCancellation();
+        if (index != 1 || value != 1) {
+            std::cerr << "WhenAny picked wrong task: " << index << "\n";
+            all_passed = false;
+        }
+    }
+
+    // 7. 取消回调
+    {
+        std::cout << "Running Task Tests7\n";
+        CancellationSource source;
+        int called = 0;
+        {
+            CancellationRegistration reg(source.GetToken(), [&] { ++called; });
+            source.RequestCancellation();
+            source.RequestCancellation();
+        }
+        CancellationRegistration late(source.GetToken(), [&] { ++called; });
+        if (called != 2) {
+            std::cerr << "cancellation callback count: " << called << "\n";
+            all_passed = false;
+        }
+    }
+
+    // 7b. 回调在其他线程上执行时注销, 析构函数等待回调结束
+    {
+        std::cout << "Running Task Tests7b\n";
+        CancellationSource source;
+        std::atomic<bool> started { false };
+        std::atomic<bool> finished { false };
+        auto registration = std::make_unique<CancellationRegistration>(source.GetToken(), [&] {
+            started = true;
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            finished = true;
+        });
+        std::thread canceller([&] { source.RequestCancellation(); });
+        while (!started) std::this_thread::yield();
+        registration.reset();
+        if (!finished) {
+            std::cerr << "registration destroyed while its callback was running\n";
+            all_passed = false;
+        }
+        canceller.join();
+
+        // 回调中注销自己不会死锁
+        CancellationSource self;
+        std::unique_ptr<CancellationRegistration> own;
+        own = std::make_unique<CancellationRegistration>(self.GetToken(), [&] { own.reset(); });
+        self.RequestCancellation();
+        if (own) {
+            std::cerr << "self-deregistration failed\n";
+            all_passed = false;
+        }
+
+        // 回调抛出异常: 其余回调照常执行, 等待它的注销不会阻塞, 之后重新抛出
+        CancellationSource failing;
+        std::atomic<bool> throwing { false };
+        std::atomic<bool> release { false };
+        int after = 0;
+        auto thrower = std::make_unique<CancellationRegistration>(failing.GetToken(), [&] {
+            throwing = true;
+            while (!release) std::this_thread::yield();
+            throw std::runtime_error("callback failed");
+        });
+        CancellationRegistration next(failing.GetToken(), [&] { ++after; });
+        bool rethrown = false;
+        std::thread failer([&] {
+            try {
+                failing.RequestCancellation();
+            } catch (const std::runtime_error&) {
+                rethrown = true;
+            }
+        });
+        while (!throwing) std::this_thread::yield();
+        std::thread releaser([&] {
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            release = true;
+        });
+        thrower.reset();
+        releaser.join();
+        failer.join();
+        if (!rethrown || after != 1) {
+            std::cerr << "throwing callback: rethrown=" << rethrown << " later callbacks=" << after << "\n";
+            all_passed = false;
+        }
+    }
+
+    // 8. Generator
+    {
+        std::cout << "Running Task Tests8\n";
+        auto range = [](int n) -> Generator<int> {
+            for (int i = 0; i < n; ++i) co_yield i;
+        };
+        int sum = 0;
+        for (int i : range(10)) sum += i;
+        if (sum != 45) {
+            std::cerr << "Generator sum: " << sum << "\n";
+            all_passed = false;
+        }
+    }
+
+    if (all_passed) {
+        std::cout << "All Task tests passed!\n";
+    } else {
+        std::cout << "Some Task tests FAILED!\n";
+    }
+    return all_passed;
+}
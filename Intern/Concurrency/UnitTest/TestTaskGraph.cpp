@@ -0,0 +1,110 @@
+#include "../TaskGraph.hpp"
+#include "../Executor.hpp"
+#include <atomic>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace Concurrency;
+
+bool TaskGraphTest() {
+    bool all_passed = true;
+    std::cout << "Running TaskGraph Tests...\n";
+    ThreadPool pool(4);
+
+    // 1. 依赖顺序: 每条边的后继必须在前驱结束之后才开始, 重复 Run 结果一致
+    {
+        std::cout << "Running TaskGraph Tests1\n";
+        constexpr int kLayers = 6;
+        constexpr int kWidth = 8;
+        TaskGraph graph;
+        std::atomic<int> clock { 0 };
+        std::vector<int> started(kLayers * kWidth, -1);
+        std::vector<int> finished(kLayers * kWidth, -1);
+        std::vector<TaskGraph::NodeId> ids;
+        for (int i = 0; i < kLayers * kWidth; ++i) {
+            ids.push_back(graph.AddNode("n" + std::to_string(i), [&, i] {
+                started[i] = clock.fetch_add(1);
+                finished[i] = clock.fetch_add(1);
+            }, static_cast<float>(1 + i % 3)));
+        }
+        std::vector<std::pair<int, int>> edges;
+        for (int layer = 1; layer < kLayers; ++layer) {
+            for (int j = 0; j < kWidth; ++j) {
+                const int after = layer * kWidth + j;
+                edges.emplace_back((layer - 1) * kWidth + j, after);
+                edges.emplace_back((layer - 1) * kWidth + (j + 3) % kWidth, after);
+            }
+        }
+        for (auto [before, after] : edges) graph.AddDependency(ids[before], ids[after]);
+        graph.Compile();
+
+        for (int run = 0; run < 50 && all_passed; ++run) {
+            graph.Run(pool);
+            for (auto [before, after] : edges) {
+                if (finished[before] < 0 || started[after] < finished[before]) {
+                    std::cerr << "run " << run << ": node " << after << " started before " << before << " finished\n";
+                    all_passed = false;
+                    break;
+                }
+            }
+        }
+    }
+
+    // 2. 错误传播: 第一个异常在所有节点结束后重新抛出, 其余节点 (包括失败节点的后继) 照常执行
+    {
+        std::cout << "Running TaskGraph Tests2\n";
+        TaskGraph graph;
+        std::atomic<int> executed { 0 };
+        auto root = graph.AddNode("root", [&] { ++executed; });
+        auto bad = graph.AddNode("bad", [&] { ++executed; throw std::runtime_error("node failed"); });
+        auto after = graph.AddNode("after", [&] { ++executed; });
+        auto side = graph.AddNode("side", [&] { ++executed; });
+        graph.AddDependency(root, bad);
+        graph.AddDependency(bad, after);
+        graph.AddDependency(root, side);
+
+        for (int run = 0; run < 2; ++run) {
+            executed = 0;
+            bool caught = false;
+            try {
+                graph.Run(pool);
+            } catch (const std::runtime_error& error) {
+                caught = std::string(error.what()) == "node failed";
+            }
+            if (!caught || executed != 4) {
+                std::cerr << "error propagation: caught=" << caught << " executed=" << executed << "\n";
+                all_passed = false;
+            }
+        }
+    }
+
+    // 3. 有环时 Compile 抛出 std::logic_error
+    {
+        std::cout << "Running TaskGraph Tests3\n";
+        TaskGraph graph;
+        auto a = graph.AddNode("a", [] {});
+        auto b = graph.AddNode("b", [] {});
+        graph.AddDependency(a, b);
+        graph.AddDependency(b, a);
+        bool threw = false;
+        try {
+            graph.Compile();
+        } catch (const std::logic_error&) {
+            threw = true;
+        }
+        if (!threw) {
+            std::cerr << "cycle was not detected\n";
+            all_passed = false;
+        }
+    }
+
+    if (all_passed) {
+        std::cout << "All TaskGraph tests passed!\n";
+    } else {
+        std::cout << "Some TaskGraph tests FAILED!\n";
+    }
+    return all_passed;
+}
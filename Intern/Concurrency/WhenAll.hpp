@@ -0,0 +1,177 @@
+#pragma once
+
+#include <atomic>
+#include <coroutine>
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "Task.hpp"
+
+namespace Concurrency{
+namespace Detail{
+/*
+ * @function: WhenAll 的计数器, 初值为 n + 1
+ * @note: 多出来的 1 属于等待者自己, 保证所有子任务同步完成时不会在挂起前恢复等待者
+ */
+class WhenAllLatch{
+public:
+    explicit WhenAllLatch(size_t count) noexcept
+        : count(count + 1) {}
+
+    void Arrive() noexcept{
+        if (count.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            continuation.resume();
+        }
+    }
+    /* 返回 true 表示需要挂起 */
+    bool TryAwait(std::coroutine_handle<> continuation) noexcept{
+        this->continuation = continuation;
+        return count.fetch_sub(1, std::memory_order_acq_rel) > 1;
+    }
+
+private:
+    std::atomic<size_t> count;
+    std::coroutine_handle<> continuation { nullptr };
+};
+
+template <typename Ty>
+DetachedTask RunWhenAllChild(Task<Ty>& task, Result<Ty>& result, WhenAllLatch& latch){
+    try {
+        if constexpr (std::is_void_v<Ty>) {
+            co_await task;
+            result.SetValue();
+        } else {
+            result.SetValue(co_await task);
+        }
+    } catch (...) {
+        result.SetException(std::current_exception());
+    }
+    /* Arrive 之后等待者可能已经销毁了 task/result/latch, 不能再访问 */
+    latch.Arrive();
+}
+
+template <typename Ty>
+struct WhenAllAwaiter{
+    std::vector<Task<Ty>>& tasks;
+    std::vector<Result<Ty>>& results;
+    WhenAllLatch& latch;
+
+    bool await_ready() const noexcept { return tasks.empty(); }
+    bool await_suspend(std::coroutine_handle<> continuation){
+        for (size_t i = 0; i < tasks.size(); ++i) {
+            RunWhenAllChild(tasks[i], results[i], latch);
+        }
+        return latch.TryAwait(continuation);
+    }
+    void await_resume() const noexcept {}
+};
+
+template <typename Ty>
+struct WhenAnyState{
+    explicit WhenAnyState(std::vector<Task<Ty>>&& tasks) noexcept
+        : tasks(std::move(tasks)) {}
+
+    std::vector<Task<Ty>> tasks;
+    Result<Ty> result;
+    size_t index { 0 };
+    std::atomic<bool> decided { false };
+    /* 胜出者与等待者各持有 1, 后到的一方负责恢复等待者 */
+    std::atomic<int> gate { 2 };
+    std::coroutine_handle<> continuation { nullptr };
+};
+
+/* state 按值持有: 失败者在 WhenAny 返回之后仍可能在运行 */
+template <typename Ty>
+DetachedTask RunWhenAnyChild(std::shared_ptr<WhenAnyState<Ty>> state, size_t index){
+    Result<Ty> result;
+    try {
+        if constexpr (std::is_void_v<Ty>) {
+            co_await state->tasks[index];
+            result.SetValue();
+        } else {
+            result.SetValue(co_await state->tasks[index]);
+        }
+    } catch (...) {
+        result.SetException(std::current_exception());
+    }
+    if (state->decided.exchange(true, std::memory_order_acq_rel)) co_return;
+    state->result = std::move(result);
+    state->index = index;
+    if (state->gate.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        state->continuation.resume();
+    }
+}
+
+/* WhenAny 的协程帧持有 state, awaiter 只借用; 不要在 awaiter 里持有 shared_ptr 临时量 (GCC 12 会析构两次) */
+template <typename Ty>
+struct WhenAnyAwaiter{
+    const std::shared_ptr<WhenAnyState<Ty>>& state;
+
+    bool await_ready() const noexcept { return false; }
+    bool await_suspend(std::coroutine_handle<> continuation){
+        for (size_t i = 0; i < state->tasks.size(); ++i) {
+            RunWhenAnyChild(state, i);
+        }
+        state->continuation = continuation;
+        return state->gate.fetch_sub(1, std::memory_order_acq_rel) > 1;
+    }
+    void await_resume() const noexcept {}
+};
+}
+
+/*
+ * @function: 并发等待所有任务完成, 按输入顺序返回结果
+ * @note: 子任务中的异常会在取结果时重新抛出 (第一个失败的下标优先)
+ */
+template <typename Ty>
+Task<std::vector<Ty>> WhenAll(std::vector<Task<Ty>> tasks){
+    std::vector<Detail::Result<Ty>> results(tasks.size());
+    Detail::WhenAllLatch latch(tasks.size());
+    co_await Detail::WhenAllAwaiter<Ty>{ tasks, results, latch };
+
+    std::vector<Ty> values;
+    values.reserve(results.size());
+    for (auto& result : results) {
+        values.push_back(result.Get());
+    }
+    co_return values;
+}
+
+inline Task<void> WhenAll(std::vector<Task<void>> tasks){
+    std::vector<Detail::Result<void>> results(tasks.size());
+    Detail::WhenAllLatch latch(tasks.size());
+    co_await Detail::WhenAllAwaiter<void>{ tasks, results, latch };
+
+    for (auto& result : results) {
+        result.Get();
+    }
+}
+
+/*
+ * @function: 等待第一个完成的任务, 返回 {下标, 结果}
+ * @note: 其余任务不会被中断, 它们会在后台运行完毕; 需要提前结束时配合 CancellationSource 使用
+ */
+template <typename Ty>
+Task<std::pair<size_t, Ty>> WhenAny(std::vector<Task<Ty>> tasks){
+    if (tasks.empty()) {
+        throw std::invalid_argument("WhenAny requires at least one task");
+    }
+    auto state = std::make_shared<Detail::WhenAnyState<Ty>>(std::move(tasks));
+    co_await Detail::WhenAnyAwaiter<Ty>{ state };
+    co_return std::pair<size_t, Ty>{ state->index, state->result.Get() };
+}
+
+inline Task<size_t> WhenAny(std::vector<Task<void>> tasks){
+    if (tasks.empty()) {
+        throw std::invalid_argument("WhenAny requires at least one task");
+    }
+    auto state = std::make_shared<Detail::WhenAnyState<void>>(std::move(tasks));
+    co_await Detail::WhenAnyAwaiter<void>{ state };
+    state->result.Get();
+    co_return state->index;
+}
+
+}
@@ -0,0 +1,56 @@
+#include <cstdint>
+#include <thread>
+#include <benchmark/benchmark.h>
+
+#include "../LatencyHistogram.hpp"
+
+namespace {
+/* 模拟延迟: 几百纳秒到几十微秒之间的值 */
+inline uint64_t NextValue(uint64_t& seed){
+    seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+    return 200 + (seed >> 40) % 50000;
+}
+
+void BM_Record(benchmark::State& state){
+    Extra::LatencyHistogram histogram;
+    uint64_t seed = 1;
+    for (auto _ : state) {
+        histogram.Record(NextValue(seed));
+    }
+    benchmark::DoNotOptimize(histogram.GetTotalCount());
+}
+
+/* 所有线程记录到同一个直方图 */
+Extra::LatencyHistogram sharedHistogram;
+void BM_RecordShared(benchmark::State& state){
+    uint64_t seed = static_cast<uint64_t>(state.thread_index()) + 1;
+    for (auto _ : state) {
+        sharedHistogram.Record(NextValue(seed));
+    }
+}
+
+/* 计时并记录 */
+void BM_ScopedLatency(benchmark::State& state){
+    Extra::LatencyHistogram histogram;
+    for (auto _ : state) {
+        Extra::ScopedLatency timer(histogram);
+        benchmark::ClobberMemory();
+    }
+}
+
+void BM_Summarize(benchmark::State& state){
+    Extra::LatencyHistogram histogram;
+    uint64_t seed = 1;
+    for (int i = 0; i < 1000000; ++i) histogram.Record(NextValue(seed));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(histogram.Summarize());
+    }
+}
+
+const int kMaxThreads = static_cast<int>(std::thread::hardware_concurrency() == 0 ? 1 : std::thread::hardware_concurrency());
+}
+
+BENCHMARK(BM_Record);
+BENCHMARK(BM_RecordShared)->ThreadRange(1, kMaxThreads)->UseRealTime();
+BENCHMARK(BM_ScopedLatency);
+BENCHMARK(BM_Summarize);
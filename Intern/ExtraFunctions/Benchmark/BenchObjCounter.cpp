@@ -0,0 +1,53 @@
+#include <thread>
+#include <benchmark/benchmark.h>
+
+#include "../ObjectCounter.hpp"
+
+namespace {
+template <template<typename> typename Extra>
+class Counted : public Extra<Counted<Extra>> {
+public:
+    int value { 0 };
+};
+
+template <typename Ty>
+class NoCounter {};
+
+/* 每次迭代构造并析构一个对象, 多线程时所有线程计数同一个类型 */
+template <template<typename> typename Extra>
+void BM_ConstructDestroy(benchmark::State& state){
+    for (auto _ : state) {
+        Counted<Extra> obj;
+        benchmark::DoNotOptimize(&obj);
+    }
+    state.SetItemsProcessed(state.iterations());
+    if (state.thread_index() == 0) {
+        benchmark::DoNotOptimize(Counted<Extra>::GetCount());
+    }
+}
+
+/* 对照: 不计数 */
+void BM_NoCounter(benchmark::State& state){
+    for (auto _ : state) {
+        Counted<NoCounter> obj;
+        benchmark::DoNotOptimize(&obj);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+/* 持有大量对象时 GetCount() 的开销 (分片需要求和) */
+template <template<typename> typename Extra>
+void BM_GetCount(benchmark::State& state){
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(Counted<Extra>::GetCount());
+    }
+}
+
+const int kMaxThreads = static_cast<int>(std::thread::hardware_concurrency() == 0 ? 1 : std::thread::hardware_concurrency());
+}
+
+BENCHMARK(BM_NoCounter)->ThreadRange(1, kMaxThreads)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_ConstructDestroy, Extra::ObjCounter)->ThreadRange(1, kMaxThreads)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_ConstructDestroy, Extra::ShardedObjCounter)->ThreadRange(1, kMaxThreads)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_GetCount, Extra::ObjCounter);
+BENCHMARK_TEMPLATE(BM_GetCount, Extra::ShardedObjCounter);
@@ -0,0 +1,54 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include "../PerfCounters.hpp"
+
+namespace {
+/* 把一次测量的计数按迭代次数平均后附加到 benchmark 的输出 */
+void ReportCounters(benchmark::State& state, const Extra::PerfCounters& counters){
+    if (!counters.hasCounters) {
+        state.SetLabel("counters unavailable");
+        return ;
+    }
+    const double iterations = static_cast<double>(state.iterations());
+    state.counters["ipc"] = counters.Ipc();
+    state.counters["cycles"] = static_cast<double>(counters.cycles) / iterations;
+    state.counters["cache-misses"] = static_cast<double>(counters.cacheMisses) / iterations;
+    state.counters["branch-misses"] = static_cast<double>(counters.branchMisses) / iterations;
+}
+
+/* 同样的求和, 按顺序 (0) 或打乱的顺序 (1) 访问 16MB 的数组; 计数说明后者慢在 cache miss 上 */
+void BM_GatherSum(benchmark::State& state){
+    std::vector<uint32_t> values(1 << 22, 1);
+    std::vector<uint32_t> order(values.size());
+    std::iota(order.begin(), order.end(), 0u);
+    if (state.range(0) != 0) std::shuffle(order.begin(), order.end(), std::mt19937{ 42 });
+
+    Extra::PerfCounters counters;
+    {
+        Extra::PerfScope scope(&counters);
+        for (auto _ : state) {
+            uint64_t sum = 0;
+            for (const uint32_t index : order) sum += values[index];
+            benchmark::DoNotOptimize(sum);
+        }
+    }
+    ReportCounters(state, counters);
+}
+
+/* 空的 PerfScope, 即两次读取计数器的开销 */
+void BM_PerfScope(benchmark::State& state){
+    Extra::PerfCounters counters;
+    for (auto _ : state) {
+        Extra::PerfScope scope(&counters);
+    }
+    state.SetLabel(Extra::PerfCounterGroup::ForThisThread().UsesRdpmc() ? "rdpmc" : "read");
+}
+}
+
+BENCHMARK(BM_GatherSum)->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_PerfScope);
@@ -0,0 +1,54 @@
+#include <benchmark/benchmark.h>
+
+#include <random>
+#include <vector>
+
+#include "../Pooled.hpp"
+
+namespace {
+template <template<typename> typename Extra>
+struct BenchNode : public Extra<BenchNode<Extra>>{
+    uint64_t key { 0 };
+    BenchNode* left { nullptr };
+    BenchNode* right { nullptr };
+};
+
+template <typename Ty>
+struct NoExtra{};
+
+using MallocNode = BenchNode<NoExtra>;
+using PooledNode = BenchNode<Extra::Pooled>;
+
+/* 一次 new + delete */
+template <typename Node>
+void BM_NewDelete(benchmark::State& state){
+    for (auto _ : state) {
+        Node* node = new Node();
+        benchmark::DoNotOptimize(node);
+        delete node;
+    }
+}
+
+/* 保持 range(0) 个存活对象, 每次迭代随机替换一个, 模拟大量小对象的反复创建与销毁 */
+template <typename Node>
+void BM_Churn(benchmark::State& state){
+    std::vector<Node*> live(static_cast<size_t>(state.range(0)));
+    for (Node*& node : live) node = new Node();
+    std::mt19937 random{ 7 };
+    std::uniform_int_distribution<size_t> pick(0, live.size() - 1);
+    for (auto _ : state) {
+        Node*& slot = live[pick(random)];
+        delete slot;
+        slot = new Node();
+        benchmark::DoNotOptimize(slot);
+    }
+    for (Node* node : live) delete node;
+}
+}
+
+BENCHMARK_TEMPLATE(BM_NewDelete, MallocNode);
+BENCHMARK_TEMPLATE(BM_NewDelete, PooledNode);
+BENCHMARK_TEMPLATE(BM_NewDelete, MallocNode)->Threads(4);
+BENCHMARK_TEMPLATE(BM_NewDelete, PooledNode)->Threads(4);
+BENCHMARK_TEMPLATE(BM_Churn, MallocNode)->Arg(1 << 16);
+BENCHMARK_TEMPLATE(BM_Churn, PooledNode)->Arg(1 << 16);
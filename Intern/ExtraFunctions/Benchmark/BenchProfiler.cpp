@@ -0,0 +1,42 @@
+#include <benchmark/benchmark.h>
+
+#include "../Profiler.hpp"
+#include "../TickClock.hpp"
+
+namespace {
+void BM_TickClock(benchmark::State& state){
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(Extra::TickClock::Now());
+    }
+}
+
+/* 采集中的一个空 zone; 每 2^20 个 zone 重新开始一次采集, 避免触及每线程的上限 */
+void BM_ProfileZone(benchmark::State& state){
+    Extra::Profiler::Start();
+    size_t zones = 0;
+    for (auto _ : state) {
+        PROFILE_ZONE("bench");
+        if (++zones == (1 << 20)) [[unlikely]] {
+            state.PauseTiming();
+            Extra::Profiler::Start();
+            zones = 0;
+            state.ResumeTiming();
+        }
+    }
+    Extra::Profiler::Stop();
+    state.counters["dropped"] = static_cast<double>(Extra::Profiler::GetDroppedCount());
+}
+
+/* 没有采集时的 zone */
+void BM_ProfileZoneIdle(benchmark::State& state){
+    Extra::Profiler::Stop();
+    for (auto _ : state) {
+        PROFILE_ZONE("bench");
+        benchmark::ClobberMemory();
+    }
+}
+}
+
+BENCHMARK(BM_TickClock);
+BENCHMARK(BM_ProfileZone);
+BENCHMARK(BM_ProfileZoneIdle);
@@ -0,0 +1,92 @@
+#include <benchmark/benchmark.h>
+
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "../RefCounted.hpp"
+
+namespace {
+/* libstdc++ 在进程只有一个线程时 shared_ptr 不使用原子操作; 先启动一个线程, 与实际的多线程程序一致 */
+const bool multiThreaded = []{
+    std::thread([]{}).join();
+    return true;
+}();
+
+template <template<typename> typename... Extras>
+struct BenchResource : public Extras<BenchResource<Extras...>>...{
+    uint64_t id { 0 };
+    float weight { 0.0f };
+};
+
+using SharedResource = BenchResource<>;
+using AtomicResource = BenchResource<Extra::RefCounted>;
+using LocalResource = BenchResource<Extra::LocalRefCounted>;
+
+template <typename Ty>
+auto Make(){
+    if constexpr (std::is_same_v<Ty, SharedResource>) {
+        return std::make_shared<Ty>();
+    } else {
+        return Extra::MakeIntrusive<Ty>();
+    }
+}
+
+/* 创建并销毁一个对象 (shared_ptr 使用 make_shared, 一次分配) */
+template <typename Ty>
+void BM_Create(benchmark::State& state){
+    for (auto _ : state) {
+        auto handle = Make<Ty>();
+        benchmark::DoNotOptimize(handle);
+    }
+    state.counters["handle-bytes"] = static_cast<double>(sizeof(Make<Ty>()));
+}
+
+/* 拷贝一个句柄再销毁, 即一次增加与一次减少引用 */
+template <typename Ty>
+void BM_CopyDestroy(benchmark::State& state){
+    auto handle = Make<Ty>();
+    for (auto _ : state) {
+        auto copy = handle;
+        benchmark::DoNotOptimize(copy);
+    }
+}
+
+/* 移动句柄: IntrusivePtr 不修改计数 */
+template <typename Ty>
+void BM_Move(benchmark::State& state){
+    auto handle = Make<Ty>();
+    for (auto _ : state) {
+        auto moved = std::move(handle);
+        benchmark::DoNotOptimize(moved);
+        handle = std::move(moved);
+    }
+}
+
+/* 把 range(0) 个句柄拷贝进 vector 再清空, 例如每帧收集渲染对象 */
+template <typename Ty>
+void BM_CopyVector(benchmark::State& state){
+    std::vector<decltype(Make<Ty>())> source;
+    for (int64_t i = 0; i < state.range(0); ++i) source.push_back(Make<Ty>());
+    std::vector<decltype(Make<Ty>())> frame;
+    frame.reserve(source.size());
+    for (auto _ : state) {
+        frame.assign(source.begin(), source.end());
+        benchmark::DoNotOptimize(frame.data());
+        frame.clear();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+}
+
+BENCHMARK_TEMPLATE(BM_Create, SharedResource);
+BENCHMARK_TEMPLATE(BM_Create, AtomicResource);
+BENCHMARK_TEMPLATE(BM_Create, LocalResource);
+BENCHMARK_TEMPLATE(BM_CopyDestroy, SharedResource);
+BENCHMARK_TEMPLATE(BM_CopyDestroy, AtomicResource);
+BENCHMARK_TEMPLATE(BM_CopyDestroy, LocalResource);
+BENCHMARK_TEMPLATE(BM_Move, SharedResource);
+BENCHMARK_TEMPLATE(BM_Move, AtomicResource);
+BENCHMARK_TEMPLATE(BM_CopyVector, SharedResource)->Arg(1024);
+BENCHMARK_TEMPLATE(BM_CopyVector, AtomicResource)->Arg(1024);
+BENCHMARK_TEMPLATE(BM_CopyVector, LocalResource)->Arg(1024);
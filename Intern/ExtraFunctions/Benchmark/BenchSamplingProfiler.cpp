@@ -0,0 +1,35 @@
+#include <benchmark/benchmark.h>
+
+#include "../SamplingProfiler.hpp"
+
+#if defined(EXTRA_HAS_SAMPLING_PROFILER)
+namespace {
+__attribute__((noinline)) double SampledWork(int n){
+    volatile double x = 0;
+    for (int i = 0; i < n; ++i) x = x + i * 0.5 / (i + 1);
+    return x;
+}
+
+/* 同一段负载在不采样 (0), 1kHz backtrace() (1) 与 1kHz 帧指针回溯 (2) 下的耗时, 差值即采样开销 */
+void BM_SampledWorkload(benchmark::State& state){
+    if (state.range(0) != 0) {
+        Extra::SamplingProfiler::Start({
+            .frequency = 1000,
+            .clock = Extra::SampleClock::WallTime,
+            .walk = state.range(0) == 1 ? Extra::StackWalk::Backtrace : Extra::StackWalk::FramePointer
+        });
+    }
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(SampledWork(100000));
+    }
+    if (state.range(0) != 0) {
+        Extra::SamplingProfiler::Stop();
+        const Extra::SamplingStats stats = Extra::SamplingProfiler::GetStats();
+        state.counters["samples"] = static_cast<double>(stats.samples);
+        state.counters["dropped"] = static_cast<double>(stats.dropped);
+    }
+}
+}
+
+BENCHMARK(BM_SampledWorkload)->Arg(0)->Arg(1)->Arg(2)->Unit(benchmark::kMicrosecond);
+#endif
@@ -0,0 +1,39 @@
+#include <benchmark/benchmark.h>
+
+#include "../Stopwatch.hpp"
+#include "../SurvivalTime.hpp"
+
+namespace {
+/* 每次迭代记录一圈: 一次读时钟 + Welford 更新 */
+template <typename Watch>
+void BM_Lap(benchmark::State& state){
+    Watch stopwatch;
+    stopwatch.Start();
+    for (auto _ : state) {
+        stopwatch.Lap();
+    }
+    benchmark::DoNotOptimize(stopwatch.GetStats());
+}
+
+/* 多个线程以 ScopedLap 记录到同一个 Stopwatch */
+void BM_ScopedLapShared(benchmark::State& state){
+    static Extra::Stopwatch<> stopwatch;
+    for (auto _ : state) {
+        Extra::ScopedLap lap(stopwatch);
+    }
+}
+
+/* 对照: 每次迭代构造并析构一个 SurvivalTime (只能计时一次) */
+void BM_SurvivalTime(benchmark::State& state){
+    for (auto _ : state) {
+        Extra::SurvivalTime<int> timer;
+        benchmark::DoNotOptimize(timer);
+    }
+}
+}
+
+BENCHMARK_TEMPLATE(BM_Lap, Extra::LocalStopwatch<>);
+BENCHMARK_TEMPLATE(BM_Lap, Extra::LocalStopwatch<Extra::SteadyTickClock>);
+BENCHMARK_TEMPLATE(BM_Lap, Extra::Stopwatch<>);
+BENCHMARK(BM_ScopedLapShared)->ThreadRange(1, 4);
+BENCHMARK(BM_SurvivalTime);
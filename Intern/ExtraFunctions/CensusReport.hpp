@@ -0,0 +1,243 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <csignal>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "../Print/Print.hpp"
+#include "ObjectCensus.hpp"
+namespace Extra{
+enum class CensusFormat{
+    Table, Json
+};
+
+namespace Detail{
+inline void AppendJsonName(std::string& out, std::string_view name){
+    out.push_back('"');
+    for (const char ch : name) {
+        if (ch == '"' || ch == '\\') out.push_back('\\');
+        out.push_back(ch);
+    }
+    out.push_back('"');
+}
+
+/* 信号处理函数只设置标志, 由 CensusReporter 的线程输出 */
+inline std::atomic<bool>& CensusRequested() noexcept {
+    static std::atomic<bool> requested { false };
+    return requested;
+}
+static_assert(std::atomic<bool>::is_always_lock_free);
+
+inline void OnCensusSignal(int) noexcept {
+    CensusRequested().store(true, std::memory_order_relaxed);
+}
+}
+
+/*
+ * @function: 把快照追加为多行的表格, 第一行是类型数与估算的总字节数
+ */
+inline void AppendCensusTable(std::string& out, const std::vector<CensusRecord>& records){
+    size_t totalBytes = 0;
+    for (const CensusRecord& record : records) totalBytes += record.Bytes();
+    out += "object census: ";
+    Tools::AppendTo(out, records.size());
+    out += " types, ";
+    Tools::AppendTo(out, totalBytes);
+    out += " bytes\n";
+
+    constexpr std::string_view kHeaders[] = { "count", "high-water", "total", "size", "bytes", "peak bytes" };
+    size_t widths[6];
+    for (size_t i = 0; i < 6; ++i) widths[i] = kHeaders[i].size();
+    /* 计数策略不记录累计构造数时 total 一列输出 "-"; 采样的峰值前加 "~" */
+    auto columns = [](const CensusRecord& record){
+        const size_t values[6] = { record.count, record.highWater, record.total, record.objectSize, record.Bytes(), record.HighWaterBytes() };
+        std::vector<std::string> cells(6);
+        for (size_t i = 0; i < 6; ++i) {
+            if (i == 2 && !record.hasTotal) {
+                cells[i] = "-";
+                continue;
+            }
+            if ((i == 1 || i == 5) && record.highWaterSampled) cells[i].push_back('~');
+            Tools::AppendTo(cells[i], values[i]);
+        }
+        return cells;
+    };
+    for (const CensusRecord& record : records) {
+        const std::vector<std::string> cells = columns(record);
+        for (size_t i = 0; i < 6; ++i) {
+            widths[i] = std::max(widths[i], cells[i].size());
+        }
+    }
+    for (size_t i = 0; i < 6; ++i) {
+        out.append(widths[i] - kHeaders[i].size(), ' ');
+        out += kHeaders[i];
+        out += "  ";
+    }
+    out += "type";
+    for (const CensusRecord& record : records) {
+        out.push_back('\n');
+        const std::vector<std::string> cells = columns(record);
+        for (size_t i = 0; i < 6; ++i) {
+            out.append(widths[i] - cells[i].size(), ' ');
+            out += cells[i];
+            out += "  ";
+        }
+        out += record.name;
+    }
+    if (std::any_of(records.begin(), records.end(), [](const CensusRecord& record){ return record.highWaterSampled; })) {
+        out += "\n~ high-water sampled at snapshots, the real peak may be higher";
+    }
+}
+
+/*
+ * @function: 把快照追加为一行 JSON
+ * @note: {"types":N,"bytes":B,"census":[{"name":..,"size":..,"count":..,"high_water":..,"high_water_sampled":..,"total":..,"bytes":..,"high_water_bytes":..}]}
+ * @      计数策略不记录累计构造数时 total 为 null; high_water_sampled 为 true 时峰值只在快照时采样
+ */
+inline void AppendCensusJson(std::string& out, const std::vector<CensusRecord>& records){
+    size_t totalBytes = 0;
+    for (const CensusRecord& record : records) totalBytes += record.Bytes();
+    out += "{\"types\":";
+    Tools::AppendTo(out, records.size());
+    out += ",\"bytes\":";
+    Tools::AppendTo(out, totalBytes);
+    out += ",\"census\":[";
+    for (size_t i = 0; i < records.size(); ++i) {
+        const CensusRecord& record = records[i];
+        if (i != 0) out.push_back(',');
+        out += "{\"name\":";
+        Detail::AppendJsonName(out, record.name);
+        out += ",\"size\":";
+        Tools::AppendTo(out, record.objectSize);
+        out += ",\"count\":";
+        Tools::AppendTo(out, record.count);
+        out += ",\"high_water\":";
+        Tools::AppendTo(out, record.highWater);
+        out += ",\"high_water_sampled\":";
+        out += record.highWaterSampled ? "true" : "false";
+        out += ",\"total\":";
+        if (record.hasTotal) Tools::AppendTo(out, record.total);
+        else out += "null";
+        out += ",\"bytes\":";
+        Tools::AppendTo(out, record.Bytes());
+        out += ",\"high_water_bytes\":";
+        Tools::AppendTo(out, record.HighWaterBytes());
+        out.push_back('}');
+    }
+    out += "]}";
+}
+
+/*
+ * @function: 对 ObjectCensus 取一次快照, 通过 Tools::Print 输出到 target (std::ostream / AsyncLogger / BufferedLogger)
+ */
+template <typename Target>
+void PrintCensus(Target& target, CensusFormat format = CensusFormat::Table, Tools::Level level = Tools::Level::Normal){
+    if (!Tools::IsLevelEnabled(level)) return ;
+    std::string text;
+    if (format == CensusFormat::Table) {
+        AppendCensusTable(text, ObjectCensus::Instance().Snapshot());
+    } else {
+        AppendCensusJson(text, ObjectCensus::Instance().Snapshot());
+    }
+    Tools::Print(target, level, text);
+}
+
+struct CensusReporterOptions{
+    std::chrono::milliseconds interval { 0 };       /* 定期输出的间隔, 0 表示不定期输出 */
+    int signal { 0 };                               /* 收到该信号时输出 (例如 SIGUSR1), 0 表示不安装信号处理 */
+    CensusFormat format { CensusFormat::Table };
+    Tools::Level level { Tools::Level::Normal };
+};
+
+/*
+ * @function: 在后台线程上定期, 或收到信号时输出 ObjectCensus
+ * @note: 信号处理函数只设置一个原子标志, 快照与输出都在后台线程上完成; 析构时恢复原来的信号处理
+ * @note: 同一时刻只应有一个 CensusReporter 安装信号处理
+ * @Usage:
+    Extra::CensusReporter reporter(logger, { .interval = std::chrono::minutes(1), .signal = SIGUSR1 });
+    // kill -USR1 <pid> 立即输出一次
+ */
+template <typename Target>
+class CensusReporter{
+public:
+    explicit CensusReporter(Target& target, CensusReporterOptions options = {})
+        : target(target), options(options){
+        if (options.signal != 0) {
+            previousHandler = std::signal(options.signal, &Detail::OnCensusSignal);
+        }
+        worker = std::thread([this]{ ReporterLoop(); });
+    }
+
+    CensusReporter(const CensusReporter&) = delete;
+    CensusReporter& operator=(const CensusReporter&) = delete;
+
+    ~CensusReporter(){
+        Stop();
+    }
+
+    /* 请求后台线程尽快输出一次 */
+    void Request() noexcept{
+        Detail::CensusRequested().store(true, std::memory_order_relaxed);
+        cv.notify_one();
+    }
+
+    void Stop(){
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (stopping) return ;
+            stopping = true;
+        }
+        cv.notify_one();
+        if (worker.joinable()) worker.join();
+        if (options.signal != 0) {
+            std::signal(options.signal, previousHandler == SIG_ERR ? SIG_DFL : previousHandler);
+        }
+    }
+
+    size_t GetReportCount() const noexcept{
+        return reports.load(std::memory_order_relaxed);
+    }
+
+private:
+    /* 信号只设置标志, 所以需要定期检查 */
+    static constexpr std::chrono::milliseconds kPollInterval { 100 };
+
+    void ReporterLoop(){
+        using Clock = std::chrono::steady_clock;
+        Clock::time_point next = Clock::now() + options.interval;
+        const std::chrono::milliseconds wait = options.interval.count() > 0 ? std::min(options.interval, kPollInterval) : kPollInterval;
+        std::unique_lock<std::mutex> lock(mutex);
+        while (!stopping) {
+            cv.wait_for(lock, wait);
+            if (stopping) break;
+            const Clock::time_point now = Clock::now();
+            const bool due = options.interval.count() > 0 && now >= next;
+            const bool requested = Detail::CensusRequested().exchange(false, std::memory_order_relaxed);
+            if (!due && !requested) continue;
+            if (due) next = now + options.interval;
+            lock.unlock();
+            PrintCensus(target, options.format, options.level);
+            reports.fetch_add(1, std::memory_order_relaxed);
+            lock.lock();
+        }
+    }
+
+private:
+    Target& target;
+    CensusReporterOptions options;
+    void (*previousHandler)(int) { SIG_DFL };
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool stopping { false };
+    std::atomic<size_t> reports { 0 };
+    std::thread worker;
+};
+
+}
@@ -0,0 +1,383 @@
+#pragma once
+
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+
+#include "TickClock.hpp"
+namespace Extra{
+/* Summarize() 的结果, 单位与记录的值相同 (通常为纳秒) */
+struct LatencySummary{
+    uint64_t count { 0 };
+    uint64_t min { 0 };
+    uint64_t max { 0 };
+    double mean { 0.0 };
+    uint64_t p50 { 0 };
+    uint64_t p90 { 0 };
+    uint64_t p99 { 0 };
+    uint64_t p999 { 0 };
+};
+
+/*
+ * @function: HdrHistogram 风格的延迟直方图, 对数分桶, 每个桶再线性细分, 相对误差由有效数字位数决定
+ * @note: 记录只有一次 relaxed fetch_add (以及很少发生的最小 / 最大值更新), 可以被多个线程同时记录, 不加锁
+ * @note: 记录频繁的多个线程可以各自使用一个实例, 查询前用 Add() 合并; 配置不同的实例不能合并
+ * @note: 超过 highestTrackableValue 的值计入最高的桶, GetMax() 仍然是真实值
+ * @note: 查询与记录可以并发进行, 此时结果是近似的; SnapshotAndReset() 用于按时间间隔输出, 不会丢失或重复计数
+ * @param: highestTrackableValue 可以记录的最大值 (默认 60 秒, 以纳秒计)
+ * @param: significantDigits 有效数字位数 1 ~ 5, 2 表示相对误差不超过 1%
+ * @Usage:
+    Extra::LatencyHistogram histogram;
+    {
+        Extra::ScopedLatency timer(histogram);
+        HandleRequest();
+    }
+    histogram.Record(elapsedNs);
+    const Extra::LatencySummary summary = histogram.Summarize();
+ */
+class LatencyHistogram{
+public:
+    static constexpr uint64_t kDefaultHighestTrackableValue = 60'000'000'000;
+
+    explicit LatencyHistogram(uint64_t highestTrackableValue = kDefaultHighestTrackableValue, int significantDigits = 2)
+        : highestTrackableValue(highestTrackableValue), significantDigits(significantDigits) {
+        if (significantDigits < 1 || significantDigits > 5) {
+            throw std::invalid_argument("LatencyHistogram: significantDigits must be in [1, 5]");
+        }
+        if (highestTrackableValue < 2) {
+            throw std::invalid_argument("LatencyHistogram: highestTrackableValue must be at least 2");
+        }
+        uint64_t largestSingleUnit = 2;
+        for (int i = 0; i < significantDigits; ++i) largestSingleUnit *= 10;
+        subBucketCountMagnitude = std::bit_width(largestSingleUnit - 1);
+        subBucketHalfCountMagnitude = subBucketCountMagnitude - 1;
+        subBucketCount = uint64_t(1) << subBucketCountMagnitude;
+        subBucketHalfCount = subBucketCount / 2;
+        subBucketMask = subBucketCount - 1;
+        leadingZeroCountBase = 64 - subBucketHalfCountMagnitude - 1;
+
+        uint64_t smallestUntrackable = subBucketCount;
+        int bucketsNeeded = 1;
+        while (smallestUntrackable <= highestTrackableValue) {
+            if (smallestUntrackable > (UINT64_MAX >> 1)) {
+                ++bucketsNeeded;
+                break;
+            }
+            smallestUntrackable <<= 1;
+            ++bucketsNeeded;
+        }
+        countsLength = static_cast<size_t>(bucketsNeeded + 1) * static_cast<size_t>(subBucketHalfCount);
+        counts = std::make_unique<std::atomic<uint64_t>[]>(countsLength);
+    }
+
+    LatencyHistogram(const LatencyHistogram& other)
+        : LatencyHistogram(other.highestTrackableValue, other.significantDigits) {
+        Add(other);
+    }
+
+    LatencyHistogram& operator=(const LatencyHistogram& other) {
+        if (this != &other) {
+            LatencyHistogram copy(other);
+            Swap(copy);
+        }
+        return *this;
+    }
+
+    void Record(uint64_t value) noexcept {
+        counts[CountsIndex(value < highestTrackableValue ? value : highestTrackableValue)].fetch_add(1, std::memory_order_relaxed);
+        UpdateMinMax(value, value);
+    }
+
+    void RecordValues(uint64_t value, uint64_t count) noexcept {
+        if (count == 0) return ;
+        counts[CountsIndex(value < highestTrackableValue ? value : highestTrackableValue)].fetch_add(count, std::memory_order_relaxed);
+        UpdateMinMax(value, value);
+    }
+
+    template <typename Rep, typename Period>
+    void Record(std::chrono::duration<Rep, Period> duration) noexcept {
+        const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+        Record(ns < 0 ? uint64_t(0) : static_cast<uint64_t>(ns));
+    }
+
+    /* 合并另一个配置相同的直方图 */
+    void Add(const LatencyHistogram& other) {
+        if (!SameLayout(other)) {
+            throw std::invalid_argument("LatencyHistogram: cannot add histograms with different configurations");
+        }
+        for (size_t i = 0; i < countsLength; ++i) {
+            const uint64_t count = other.counts[i].load(std::memory_order_relaxed);
+            if (count != 0) counts[i].fetch_add(count, std::memory_order_relaxed);
+        }
+        const uint64_t otherMin = other.minValue.load(std::memory_order_relaxed);
+        const uint64_t otherMax = other.maxValue.load(std::memory_order_relaxed);
+        if (otherMin <= otherMax) UpdateMinMax(otherMin, otherMax);
+    }
+
+    /* 返回到目前为止的计数并清零, 用于按时间间隔输出 */
+    LatencyHistogram SnapshotAndReset() {
+        LatencyHistogram interval(highestTrackableValue, significantDigits);
+        for (size_t i = 0; i < countsLength; ++i) {
+            if (counts[i].load(std::memory_order_relaxed) != 0) {
+                interval.counts[i].store(counts[i].exchange(0, std::memory_order_relaxed), std::memory_order_relaxed);
+            }
+        }
+        interval.minValue.store(minValue.exchange(UINT64_MAX, std::memory_order_relaxed), std::memory_order_relaxed);
+        interval.maxValue.store(maxValue.exchange(0, std::memory_order_relaxed), std::memory_order_relaxed);
+        return interval;
+    }
+
+    void Reset() noexcept {
+        for (size_t i = 0; i < countsLength; ++i) counts[i].store(0, std::memory_order_relaxed);
+        minValue.store(UINT64_MAX, std::memory_order_relaxed);
+        maxValue.store(0, std::memory_order_relaxed);
+    }
+
+    uint64_t GetTotalCount() const noexcept {
+        uint64_t total = 0;
+        for (size_t i = 0; i < countsLength; ++i) total += counts[i].load(std::memory_order_relaxed);
+        return total;
+    }
+
+    uint64_t GetMin() const noexcept {
+        const uint64_t value = minValue.load(std::memory_order_relaxed);
+        return value == UINT64_MAX ? 0 : value;
+    }
+
+    uint64_t GetMax() const noexcept {
+        return maxValue.load(std::memory_order_relaxed);
+    }
+
+    /*
+     * @function: 不小于 percentile% 的记录所在桶的最大等价值 (与 HdrHistogram 一致), 不超过 GetMax()
+     * @param: percentile 0 ~ 100
+     */
+    uint64_t ValueAtPercentile(double percentile) const noexcept {
+        return ValueAtPercentile(percentile, GetTotalCount());
+    }
+
+    double GetMean() const noexcept {
+        uint64_t total = 0;
+        double sum = 0.0;
+        for (size_t i = 0; i < countsLength; ++i) {
+            const uint64_t count = counts[i].load(std::memory_order_relaxed);
+            if (count == 0) continue;
+            total += count;
+            sum += static_cast<double>(MedianEquivalentValue(ValueFromIndex(i))) * static_cast<double>(count);
+        }
+        return total == 0 ? 0.0 : sum / static_cast<double>(total);
+    }
+
+    LatencySummary Summarize() const noexcept {
+        LatencySummary summary;
+        summary.count = GetTotalCount();
+        if (summary.count == 0) return summary;
+        summary.min = GetMin();
+        summary.max = GetMax();
+        summary.mean = GetMean();
+        summary.p50 = ValueAtPercentile(50.0, summary.count);
+        summary.p90 = ValueAtPercentile(90.0, summary.count);
+        summary.p99 = ValueAtPercentile(99.0, summary.count);
+        summary.p999 = ValueAtPercentile(99.9, summary.count);
+        return summary;
+    }
+
+    /* 依次访问非空的桶: visit(桶内最小值, 桶内最大值, 计数) */
+    template <typename Visit>
+    void ForEachBucket(Visit&& visit) const {
+        for (size_t i = 0; i < countsLength; ++i) {
+            const uint64_t count = counts[i].load(std::memory_order_relaxed);
+            if (count == 0) continue;
+            const uint64_t value = ValueFromIndex(i);
+            visit(LowestEquivalentValue(value), HighestEquivalentValue(value), count);
+        }
+    }
+
+    uint64_t GetHighestTrackableValue() const noexcept {
+        return highestTrackableValue;
+    }
+    int GetSignificantDigits() const noexcept {
+        return significantDigits;
+    }
+    /* 计数数组占用的字节数 */
+    size_t GetMemorySize() const noexcept {
+        return countsLength * sizeof(std::atomic<uint64_t>);
+    }
+
+private:
+    int BucketIndex(uint64_t value) const noexcept {
+        return leadingZeroCountBase - std::countl_zero(value | subBucketMask);
+    }
+
+    size_t CountsIndex(uint64_t value) const noexcept {
+        const int bucketIndex = BucketIndex(value);
+        const uint64_t subBucketIndex = value >> bucketIndex;
+        return (static_cast<size_t>(bucketIndex + 1) << subBucketHalfCountMagnitude) + static_cast<size_t>(subBucketIndex - subBucketHalfCount);
+    }
+
+    uint64_t ValueFromIndex(size_t index) const noexcept {
+        int bucketIndex = static_cast<int>(index >> subBucketHalfCountMagnitude) - 1;
+        uint64_t subBucketIndex = (index & (subBucketHalfCount - 1)) + subBucketHalfCount;
+        if (bucketIndex < 0) {
+            subBucketIndex -= subBucketHalfCount;
+            bucketIndex = 0;
+        }
+        return subBucketIndex << bucketIndex;
+    }
+
+    uint64_t SizeOfEquivalentRange(uint64_t value) const noexcept {
+        const int bucketIndex = BucketIndex(value);
+        const uint64_t subBucketIndex = value >> bucketIndex;
+        return uint64_t(1) << (subBucketIndex >= subBucketCount ? bucketIndex + 1 : bucketIndex);
+    }
+
+    uint64_t LowestEquivalentValue(uint64_t value) const noexcept {
+        const int bucketIndex = BucketIndex(value);
+        return (value >> bucketIndex) << bucketIndex;
+    }
+
+    uint64_t HighestEquivalentValue(uint64_t value) const noexcept {
+        return LowestEquivalentValue(value) + SizeOfEquivalentRange(value) - 1;
+    }
+
+    uint64_t MedianEquivalentValue(uint64_t value) const noexcept {
+        return LowestEquivalentValue(value) + (SizeOfEquivalentRange(value) >> 1);
+    }
+
+    uint64_t ValueAtPercentile(double percentile, uint64_t total) const noexcept {
+        if (total == 0) return 0;
+        const double clamped = percentile < 0.0 ? 0.0 : (percentile > 100.0 ? 100.0 : percentile);
+        uint64_t target = static_cast<uint64_t>(std::ceil(clamped / 100.0 * static_cast<double>(total)));
+        if (target == 0) target = 1;
+        uint64_t running = 0;
+        for (size_t i = 0; i < countsLength; ++i) {
+            running += counts[i].load(std::memory_order_relaxed);
+            if (running >= target) {
+                const uint64_t value = HighestEquivalentValue(ValueFromIndex(i));
+                const uint64_t max = GetMax();
+                return value < max ? value : max;
+            }
+        }
+        return GetMax();
+    }
+
+    void UpdateMinMax(uint64_t low, uint64_t high) noexcept {
+        uint64_t current = minValue.load(std::memory_order_relaxed);
+        while (low < current && !minValue.compare_exchange_weak(current, low, std::memory_order_relaxed)) {}
+        current = maxValue.load(std::memory_order_relaxed);
+        while (high > current && !maxValue.compare_exchange_weak(current, high, std::memory_order_relaxed)) {}
+    }
+
+    bool SameLayout(const LatencyHistogram& other) const noexcept {
+        return countsLength == other.countsLength && subBucketCount == other.subBucketCount
+            && highestTrackableValue == other.highestTrackableValue;
+    }
+
+    void Swap(LatencyHistogram& other) noexcept {
+        std::swap(highestTrackableValue, other.highestTrackableValue);
+        std::swap(significantDigits, other.significantDigits);
+        std::swap(subBucketCountMagnitude, other.subBucketCountMagnitude);
+        std::swap(subBucketHalfCountMagnitude, other.subBucketHalfCountMagnitude);
+        std::swap(leadingZeroCountBase, other.leadingZeroCountBase);
+        std::swap(subBucketCount, other.subBucketCount);
+        std::swap(subBucketHalfCount, other.subBucketHalfCount);
+        std::swap(subBucketMask, other.subBucketMask);
+        std::swap(countsLength, other.countsLength);
+        std::swap(counts, other.counts);
+        const uint64_t min = minValue.load(std::memory_order_relaxed);
+        minValue.store(other.minValue.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        other.minValue.store(min, std::memory_order_relaxed);
+        const uint64_t max = maxValue.load(std::memory_order_relaxed);
+        maxValue.store(other.maxValue.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        other.maxValue.store(max, std::memory_order_relaxed);
+    }
+
+private:
+    uint64_t highestTrackableValue;
+    int significantDigits;
+    int subBucketCountMagnitude { 0 };
+    int subBucketHalfCountMagnitude { 0 };
+    int leadingZeroCountBase { 0 };
+    uint64_t subBucketCount { 0 };
+    uint64_t subBucketHalfCount { 0 };
+    uint64_t subBucketMask { 0 };
+    size_t countsLength { 0 };
+    std::unique_ptr<std::atomic<uint64_t>[]> counts;
+    std::atomic<uint64_t> minValue { UINT64_MAX };
+    std::atomic<uint64_t> maxValue { 0 };
+};
+
+/*
+ * @function: 把构造到析构之间的时间 (纳秒) 记录到直方图
+ */
+class ScopedLatency{
+public:
+    explicit ScopedLatency(LatencyHistogram& histogram) noexcept
+        : histogram(histogram), begin(TickClock::Now()) {}
+
+    ScopedLatency(const ScopedLatency&) = delete;
+    ScopedLatency& operator=(const ScopedLatency&) = delete;
+
+    ~ScopedLatency() noexcept {
+        histogram.Record(static_cast<uint64_t>(TickClock::ToNs(TickClock::Now() - begin)));
+    }
+
+private:
+    LatencyHistogram& histogram;
+    uint64_t begin;
+};
+
+/**
+    按类型统计对象寿命的分布, 与 SurvivalTime 一起使用时, 前者给出单个对象的寿命, 这里给出该类型所有对象寿命的分布
+
+    template <template<typename> typename Extra>
+    class YourClass : public Extra<YourClass<Extra>> {};
+
+    YourClass<Extra::LifetimeHistogram>::GetLifetimeHistogram().Summarize()
+*/
+template <typename Ty>
+class LifetimeHistogram{
+public:
+    /* 寿命最长记录 1 天, 更长的计入最高的桶 */
+    static constexpr uint64_t kHighestLifetimeNs = 86'400'000'000'000;
+
+    LifetimeHistogram() noexcept
+        : born(TickClock::Now()) {}
+
+    LifetimeHistogram(const LifetimeHistogram&) noexcept
+        : born(TickClock::Now()) {}
+
+    LifetimeHistogram(LifetimeHistogram&&) noexcept
+        : born(TickClock::Now()) {}
+
+    ~LifetimeHistogram() noexcept {
+        GetLifetimeHistogram().Record(ExtraLifetimeNs());
+    }
+
+    LifetimeHistogram& operator=(const LifetimeHistogram&) noexcept { return *this; }
+    LifetimeHistogram& operator=(LifetimeHistogram&&) noexcept { return *this; }
+
+    /* 当前对象已经存活的纳秒数 */
+    uint64_t ExtraLifetimeNs() const noexcept {
+        return static_cast<uint64_t>(TickClock::ToNs(TickClock::Now() - born));
+    }
+
+    /*
+     * 该类型所有已析构对象的寿命分布 (纳秒)
+     * 直方图不析构: 第一次析构才创建它时, 它比先构造的全局对象析构得更早, 之后的析构会写入已释放的内存
+     */
+    static LatencyHistogram& GetLifetimeHistogram() {
+        static LatencyHistogram* histogram = new LatencyHistogram(kHighestLifetimeNs, 2);
+        return *histogram;
+    }
+
+private:
+    uint64_t born;
+};
+
+}
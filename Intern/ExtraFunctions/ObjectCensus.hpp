@@ -0,0 +1,135 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <mutex>
+#include <string_view>
+#include <vector>
+namespace Extra{
+namespace Detail{
+/* 由编译器的函数签名得到类型名, 不依赖 RTTI */
+template <typename Ty>
+constexpr std::string_view TypeName() noexcept {
+#if defined(_MSC_VER) && !defined(__clang__)
+    /* "... __cdecl Extra::Detail::TypeName<class Foo>(void) noexcept" */
+    constexpr std::string_view signature = __FUNCSIG__;
+    const size_t begin = signature.find("TypeName<") + 9;
+    std::string_view name = signature.substr(begin, signature.rfind(">(void)") - begin);
+    for (const std::string_view tag : { std::string_view("class "), std::string_view("struct "), std::string_view("enum ") }) {
+        if (name.substr(0, tag.size()) == tag) name.remove_prefix(tag.size());
+    }
+    return name;
+#else
+    /* GCC: "... [with Ty = Foo; std::string_view = ...]", Clang: "... [Ty = Foo]" */
+    constexpr std::string_view signature = __PRETTY_FUNCTION__;
+    const size_t begin = signature.find("Ty = ") + 5;
+    size_t end = signature.find(';', begin);
+    if (end == std::string_view::npos) end = signature.rfind(']');
+    return signature.substr(begin, end - begin);
+#endif
+}
+}
+
+/* 一个类型在快照时刻的计数 */
+struct CensusRecord{
+    std::string_view name;
+    size_t objectSize { 0 };        /* sizeof(T) */
+    size_t count { 0 };             /* 当前存活 */
+    size_t highWater { 0 };         /* 存活数的峰值 */
+    bool highWaterSampled { false };    /* 峰值只在读取计数时采样 (ShardedCount), 可能低于真实峰值 */
+    size_t total { 0 };             /* 累计构造, 计数策略不记录时 hasTotal 为 false */
+    bool hasTotal { false };
+
+    /* 只按 sizeof(T) 估算, 不包括对象自己持有的堆内存 */
+    size_t Bytes() const noexcept {
+        return count * objectSize;
+    }
+    size_t HighWaterBytes() const noexcept {
+        return highWater * objectSize;
+    }
+};
+
+/*
+ * @function: 进程内所有 ObjCounter<T> 的登记表
+ * @note: 每个 ObjCounter<T> 在静态初始化时自动登记 (类型名, sizeof(T), 计数策略的地址), 没有运行时开销;
+ * @      只有 Snapshot() 需要加锁并读取所有类型的计数
+ * @note: 计数策略需要提供 Load() / LoadHighWater(), LoadTotal() 与 kSampledHighWater 可选; 见 ObjectCounter.hpp 中的 ExactCount / ShardedCount
+ * @Usage:
+    for (const Extra::CensusRecord& record : Extra::ObjectCensus::Instance().Snapshot()) {
+        std::cout << record.name << " " << record.count << " " << record.Bytes() << "\n";
+    }
+    Extra::PrintCensus(logger);     // 见 CensusReport.hpp
+ */
+class ObjectCensus{
+public:
+    static ObjectCensus& Instance() noexcept {
+        static ObjectCensus census;
+        return census;
+    }
+
+    ObjectCensus(const ObjectCensus&) = delete;
+    ObjectCensus& operator=(const ObjectCensus&) = delete;
+
+    template <typename Ty, typename Policy>
+    bool Register(const Policy& counter) {
+        std::lock_guard<std::mutex> lock(mutex);
+        entries.push_back(Entry{ Detail::TypeName<Ty>(), sizeof(Ty), &counter, &Read<Policy> });
+        return true;
+    }
+
+    /* 所有已登记类型的计数, 按当前估算字节数从大到小排序 */
+    std::vector<CensusRecord> Snapshot() const {
+        std::vector<CensusRecord> records;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            records.reserve(entries.size());
+            for (const Entry& entry : entries) {
+                CensusRecord record = entry.read(entry.counter);
+                record.name = entry.name;
+                record.objectSize = entry.objectSize;
+                records.push_back(record);
+            }
+        }
+        std::sort(records.begin(), records.end(), [](const CensusRecord& lhs, const CensusRecord& rhs){
+            return lhs.Bytes() != rhs.Bytes() ? lhs.Bytes() > rhs.Bytes() : lhs.name < rhs.name;
+        });
+        return records;
+    }
+
+    size_t GetTypeCount() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return entries.size();
+    }
+
+private:
+    ObjectCensus() = default;
+
+    struct Entry{
+        std::string_view name;
+        size_t objectSize;
+        const void* counter;
+        CensusRecord (*read)(const void*);
+    };
+
+    template <typename Policy>
+    static CensusRecord Read(const void* counter) {
+        const Policy& policy = *static_cast<const Policy*>(counter);
+        CensusRecord record;
+        record.count = policy.Load();               /* 先读当前数, 分片策略会在这里更新峰值 */
+        if constexpr (requires { policy.LoadTotal(); }) {
+            record.total = policy.LoadTotal();
+            record.hasTotal = true;
+        }
+        if constexpr (requires { Policy::kSampledHighWater; }) {
+            record.highWaterSampled = Policy::kSampledHighWater;
+        }
+        record.highWater = std::max(policy.LoadHighWater(), record.count);
+        return record;
+    }
+
+private:
+    mutable std::mutex mutex;
+    std::vector<Entry> entries;
+};
+
+}
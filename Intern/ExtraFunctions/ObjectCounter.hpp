@@ -2,40 +2,165 @@
 
 #include <atomic>
 #include <cstddef>
+#include <cstdint>
+
+#include "../Concurrency/CacheLine.hpp"
+#include "ObjectCensus.hpp"
 namespace Extra{
+namespace Detail{
+/* 当前线程的分片序号, 线程第一次使用时按顺序分配, 所有类型共用 */
+inline size_t ThreadShardIndex() noexcept {
+    static std::atomic<size_t> next { 0 };
+    thread_local const size_t index = next.fetch_add(1, std::memory_order_relaxed);
+    return index;
+}
+}
+
+/*
+ * @function: ObjCounter 的默认计数策略, 一个共享的原子变量
+ * @note: GetCount() 在任何时刻都是精确值, 构造 / 析构各一次原子操作, 但所有线程写同一条缓存行
+ * @note: 峰值是精确的: 构造时用 fetch_add 的返回值与峰值比较, 只有出现新的峰值时才多一次 CAS
+ * @note: 不记录累计构造数; 需要在 ObjectCensus 中看到 total 时使用 ExactCountWithTotal
+ */
+struct ExactCount{
+    void Increment() noexcept {
+        const size_t now = count.fetch_add(1) + 1;
+        size_t peak = highWater.load(std::memory_order_relaxed);
+        while (now > peak && !highWater.compare_exchange_weak(peak, now, std::memory_order_relaxed)) {}
+    }
+    void Decrement() noexcept {
+        count.fetch_sub(1);
+    }
+    size_t Load() const noexcept {
+        return count.load();
+    }
+    size_t LoadHighWater() const noexcept {
+        return highWater.load(std::memory_order_relaxed);
+    }
+
+    std::atomic<size_t> count { 0 };
+    std::atomic<size_t> highWater { 0 };
+};
+
+/*
+ * @function: ExactCount 加上累计构造数, 构造时多一次 relaxed 原子操作 (与计数在不同的缓存行)
+ */
+struct ExactCountWithTotal : ExactCount{
+    void Increment() noexcept {
+        ExactCount::Increment();
+        total.fetch_add(1, std::memory_order_relaxed);
+    }
+    size_t LoadTotal() const noexcept {
+        return total.load(std::memory_order_relaxed);
+    }
+
+    alignas(Concurrency::kCacheLineSize) std::atomic<size_t> total { 0 };
+};
+
+/*
+ * @function: 分片的计数策略, 每个线程写自己的分片 (独占缓存行), GetCount() 时求和
+ * @note: 分片分别记录构造数与析构数, 构造 / 析构都只有一次 relaxed 原子操作; 线程多于 Shards 时按序号共用分片
+ * @note: 并发构造 / 析构时求和的结果不是某一时刻的快照, 没有并发修改时是精确值
+ * @note: 峰值只在 GetCount() (包括 ObjectCensus 的快照) 时更新, 是采样到的峰值 (kSampledHighWater), 两次读取之间的峰值会被漏掉
+ * @note: 每个被计数的类型占用 Shards 条缓存行
+ */
+template <size_t Shards = 32>
+struct ShardedCount{
+    static_assert(Shards > 0 && (Shards & (Shards - 1)) == 0, "Shards must be a power of two");
+    static constexpr bool kSampledHighWater = true;
+
+    struct Shard{
+        std::atomic<uint64_t> constructed { 0 };
+        std::atomic<uint64_t> destroyed { 0 };
+    };
+
+    void Increment() noexcept {
+        Local().constructed.fetch_add(1, std::memory_order_relaxed);
+    }
+    void Decrement() noexcept {
+        Local().destroyed.fetch_add(1, std::memory_order_relaxed);
+    }
+    size_t Load() const noexcept {
+        /* 先读析构数, 再读构造数, 结果不会因为读取顺序小于 0 */
+        uint64_t destroyed = 0;
+        for (const auto& shard : shards) {
+            destroyed += shard.value.destroyed.load(std::memory_order_relaxed);
+        }
+        const uint64_t constructed = LoadTotal();
+        const size_t now = constructed > destroyed ? static_cast<size_t>(constructed - destroyed) : 0;
+        size_t peak = highWater.load(std::memory_order_relaxed);
+        while (now > peak && !highWater.compare_exchange_weak(peak, now, std::memory_order_relaxed)) {}
+        return now;
+    }
+    size_t LoadTotal() const noexcept {
+        uint64_t constructed = 0;
+        for (const auto& shard : shards) {
+            constructed += shard.value.constructed.load(std::memory_order_relaxed);
+        }
+        return static_cast<size_t>(constructed);
+    }
+    size_t LoadHighWater() const noexcept {
+        return highWater.load(std::memory_order_relaxed);
+    }
+
+    Shard& Local() noexcept {
+        return shards[Detail::ThreadShardIndex() & (Shards - 1)].value;
+    }
+
+    Concurrency::CacheAligned<Shard> shards[Shards];
+    mutable std::atomic<size_t> highWater { 0 };
+};
+
 /**
     template <template<typename> typename Extra>
     class YourClass : public Extra<YourClass<Extra>> {};
 
     YourClass<Extra::ObjCounter>::GetCount()
+    YourClass<Extra::ShardedObjCounter>::GetCount()     // 多线程频繁构造的类型
+
+    BasicObjCounter<Ty, Policy> 可以指定其他计数策略; 作为模板模板参数时使用下面只有一个参数的别名
+    (Clang 19 之前没有实现 P0522, 带默认参数的两参数模板不能匹配 template<typename> typename)
 */
-template <typename Ty>
-class ObjCounter{
+template <typename Ty, typename Policy>
+class BasicObjCounter{
 public:
-    ObjCounter() noexcept {
-        count.fetch_add(1);
+    BasicObjCounter() noexcept {
+        (void)registered;
+        count.Increment();
     }
 
-    ObjCounter(const ObjCounter&) noexcept {
-        count.fetch_add(1);
+    BasicObjCounter(const BasicObjCounter&) noexcept {
+        (void)registered;
+        count.Increment();
     }
 
-    ObjCounter(ObjCounter&&) noexcept {
-        count.fetch_add(1);
+    BasicObjCounter(BasicObjCounter&&) noexcept {
+        (void)registered;
+        count.Increment();
     }
 
-    ~ObjCounter() noexcept {
-        count.fetch_sub(1);
+    ~BasicObjCounter() noexcept {
+        count.Decrement();
     }
 
-    ObjCounter& operator=(const ObjCounter&) noexcept = default;
-    ObjCounter& operator=(ObjCounter&&) noexcept = default;
+    BasicObjCounter& operator=(const BasicObjCounter&) noexcept = default;
+    BasicObjCounter& operator=(BasicObjCounter&&) noexcept = default;
 
     static size_t GetCount() noexcept {
-        return count.load();
+        return count.Load();
     }
 private:
-    static inline std::atomic<size_t> count = 0;
+    static inline Policy count {};
+    /* 在静态初始化时把该类型登记到 ObjectCensus; 构造函数中引用它以保证被实例化 */
+    static inline const bool registered = ObjectCensus::Instance().Register<Ty>(count);
 };
 
-}
\ No newline at end of file
+/* 原来的 ObjCounter, 精确计数 */
+template <typename Ty>
+using ObjCounter = BasicObjCounter<Ty, ExactCount>;
+
+/* 以分片计数的 ObjCounter, 可以直接作为 template <typename> 的模板模板参数 */
+template <typename Ty>
+using ShardedObjCounter = BasicObjCounter<Ty, ShardedCount<>>;
+
+}
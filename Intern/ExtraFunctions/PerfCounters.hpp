@@ -0,0 +1,382 @@
+#pragma once
+
+#include <cstdint>
+
+#include "TickClock.hpp"
+
+#if defined(__linux__)
+#include <cstring>
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#define EXTRA_HAS_PERF_EVENTS 1
+#endif
+
+namespace Extra{
+enum class PerfEvent : uint8_t{
+    Cycles, Instructions, CacheMisses, BranchMisses
+};
+inline constexpr size_t kPerfEventCount = 4;
+
+/*
+ * @function: 一段区间内的硬件计数与耗时
+ * @note: 计数器不可用时 (非 Linux, 容器或 perf_event_paranoid 禁止, 虚拟机没有 PMU) hasCounters 为 false, 只有 ns 有效
+ */
+struct PerfCounters{
+    uint64_t cycles { 0 };
+    uint64_t instructions { 0 };
+    uint64_t cacheMisses { 0 };
+    uint64_t branchMisses { 0 };
+    double ns { 0.0 };
+    bool hasCounters { false };
+
+    /* 每周期执行的指令数 */
+    double Ipc() const noexcept {
+        return cycles != 0 ? static_cast<double>(instructions) / static_cast<double>(cycles) : 0.0;
+    }
+
+    PerfCounters& operator+=(const PerfCounters& other) noexcept {
+        cycles += other.cycles;
+        instructions += other.instructions;
+        cacheMisses += other.cacheMisses;
+        branchMisses += other.branchMisses;
+        ns += other.ns;
+        hasCounters = hasCounters || other.hasCounters;
+        return *this;
+    }
+};
+
+/*
+ * @function: 一次读取的原始累计计数 (不放大) 与 group 的 enabled / running 时间 (纳秒)
+ * @note: 计数器被复用 (multiplexing) 时, 两次读取之差按 (enabled 之差) / (running 之差) 放大, 见 PerfCounterGroup::Delta
+ */
+struct PerfSample{
+    uint64_t values[kPerfEventCount] { };
+    uint64_t timeEnabled { 0 };
+    uint64_t timeRunning { 0 };
+    bool viaRdpmc { false };            /* 这次读取是否用的 rdpmc */
+};
+
+/*
+ * @function: 当前线程的一组硬件计数器 (cycles, instructions, cache misses, branch misses), 只统计用户态
+ * @note: 以 cycles 为 leader 打开为一个 group, 内核同时调度组内的计数器, 比值 (IPC 等) 才有意义;
+ * @      单个事件不支持时 (例如部分虚拟机没有 cache misses) 只缺少该事件, 全部失败时 IsAvailable() 为 false, 不抛出异常
+ * @note: 内核允许时 (perf_event_mmap_page::cap_user_rdpmc) 用 rdpmc 在用户态读取, 约几十个周期; 否则一次 read() 系统调用;
+ * @      打开时比较两种方式的耗时, 虚拟机中 rdpmc 被捕获而更慢时使用 read()
+ * @note: 两种方式读到的都是原始计数与 enabled / running 时间 (rdpmc 时取自 mmap 页并外推到当前时刻), 放大只在求差时进行
+ * @note: 计数器只统计打开它的线程, 所以只能在该线程上读取; 一般通过 ForThisThread() 使用
+ */
+class PerfCounterGroup{
+public:
+    PerfCounterGroup() noexcept {
+#if defined(EXTRA_HAS_PERF_EVENTS)
+        constexpr uint64_t kConfigs[kPerfEventCount] = {
+            PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES
+        };
+        for (size_t i = 0; i < kPerfEventCount; ++i) {
+            perf_event_attr attr;
+            std::memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = kConfigs[i];
+            attr.disabled = leader < 0 ? 1 : 0;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_ID | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+            const int fd = static_cast<int>(::syscall(SYS_perf_event_open, &attr, 0, -1, leader, 0));
+            if (fd < 0) continue;
+            if (leader < 0) {
+                leader = fd;
+                leaderIndex = i;
+            }
+            fds[i] = fd;
+            ::ioctl(fd, PERF_EVENT_IOC_ID, &ids[i]);
+        }
+        if (leader < 0) return ;
+        if (::ioctl(leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP) != 0) {
+            Close();
+            return ;
+        }
+#if defined(__x86_64__) || defined(__i386__)
+        usesRdpmc = true;
+        for (size_t i = 0; i < kPerfEventCount && usesRdpmc; ++i) {
+            if (fds[i] < 0) continue;
+            void* page = ::mmap(nullptr, static_cast<size_t>(::sysconf(_SC_PAGESIZE)), PROT_READ, MAP_SHARED, fds[i], 0);
+            if (page == MAP_FAILED) {
+                usesRdpmc = false;
+                break;
+            }
+            pages[i] = static_cast<perf_event_mmap_page*>(page);
+            usesRdpmc = pages[i]->cap_user_rdpmc != 0;
+        }
+        /* 虚拟机中 rdpmc 可能被 hypervisor 捕获, 每个计数器一次 VM exit, 反而比一次 read() 慢; 各测几次取较快的方式 */
+        if (usesRdpmc) {
+            PerfSample sample;
+            uint64_t rdpmcTicks = ~uint64_t(0);
+            uint64_t readTicks = ~uint64_t(0);
+            for (int round = 0; round < 4; ++round) {
+                uint64_t start = TickClock::Now();
+                const bool ok = ReadRdpmc(sample);
+                uint64_t end = TickClock::Now();
+                if (ok && end - start < rdpmcTicks) rdpmcTicks = end - start;
+                start = TickClock::Now();
+                ReadGroup(sample);
+                end = TickClock::Now();
+                if (end - start < readTicks) readTicks = end - start;
+            }
+            usesRdpmc = rdpmcTicks < readTicks;
+        }
+#endif
+#endif
+    }
+
+    PerfCounterGroup(const PerfCounterGroup&) = delete;
+    PerfCounterGroup& operator=(const PerfCounterGroup&) = delete;
+
+    ~PerfCounterGroup(){
+        Close();
+    }
+
+    /* 当前线程的计数器, 第一次调用时打开 */
+    static PerfCounterGroup& ForThisThread() noexcept {
+        thread_local PerfCounterGroup group;
+        return group;
+    }
+
+    bool IsAvailable() const noexcept {
+        return leader >= 0;
+    }
+
+    bool Has(PerfEvent event) const noexcept {
+        return fds[static_cast<size_t>(event)] >= 0;
+    }
+
+    bool UsesRdpmc() const noexcept {
+        return usesRdpmc;
+    }
+
+    /*
+     * 读取原始累计计数, 不可用的事件为 0; 返回 false 表示计数器不可用
+     * preferRdpmc 为 false 时总是 read(); 计数器当前不在 PMU 上 (rdpmc 读不到) 时也退回 read(), 两种方式的原始计数相同
+     */
+    bool Read(PerfSample& sample, bool preferRdpmc = true) const noexcept {
+        sample = PerfSample{};
+        if (leader < 0) return false;
+        if (preferRdpmc && usesRdpmc && ReadRdpmc(sample)) return true;
+        sample = PerfSample{};
+        return ReadGroup(sample);
+    }
+
+    /* 两次读取之间的计数; 被复用时按这段区间内 enabled / running 的时间比例放大 */
+    static void Delta(const PerfSample& begin, const PerfSample& end, uint64_t (&values)[kPerfEventCount]) noexcept {
+        const uint64_t enabled = end.timeEnabled - begin.timeEnabled;
+        const uint64_t running = end.timeRunning - begin.timeRunning;
+        const double scale = running != 0 && running < enabled
+            ? static_cast<double>(enabled) / static_cast<double>(running) : 1.0;
+        for (size_t i = 0; i < kPerfEventCount; ++i) {
+            const uint64_t raw = end.values[i] >= begin.values[i] ? end.values[i] - begin.values[i] : 0;
+            values[i] = scale == 1.0 ? raw : static_cast<uint64_t>(static_cast<double>(raw) * scale);
+        }
+    }
+
+private:
+    /*
+     * 按 perf_event_open(2) 中 perf_event_mmap_page 的 seqlock 协议读取; 计数器当前不在 PMU 上 (index == 0) 时返回 false
+     * enabled / running 时间取自 leader 的页, cap_user_time 时用 TSC 外推到当前时刻, 与 read() 返回的时间一致
+     */
+    bool ReadRdpmc(PerfSample& sample) const noexcept {
+#if defined(EXTRA_HAS_PERF_EVENTS) && (defined(__x86_64__) || defined(__i386__))
+        for (size_t i = 0; i < kPerfEventCount; ++i) {
+            const perf_event_mmap_page* page = pages[i];
+            if (page == nullptr) continue;
+            uint32_t sequence = 0;
+            uint64_t count = 0;
+            uint64_t enabled = 0;
+            uint64_t running = 0;
+            do {
+                sequence = page->lock;
+                asm volatile("" ::: "memory");
+                const uint32_t index = page->index;
+                if (index == 0) return false;
+                enabled = page->time_enabled;
+                running = page->time_running;
+                if (i == leaderIndex && page->cap_user_time) {
+                    const uint64_t cycles = ReadTsc();
+                    const uint16_t shift = page->time_shift;
+                    const uint64_t quot = cycles >> shift;
+                    const uint64_t rem = cycles & ((uint64_t(1) << shift) - 1);
+                    const uint64_t delta = page->time_offset + quot * page->time_mult + ((rem * page->time_mult) >> shift);
+                    enabled += delta;
+                    running += delta;
+                }
+                int64_t pmc = static_cast<int64_t>(ReadPmc(index - 1));
+                const uint16_t width = page->pmc_width;
+                pmc = static_cast<int64_t>(static_cast<uint64_t>(pmc) << (64 - width)) >> (64 - width);
+                count = static_cast<uint64_t>(page->offset + pmc);
+                asm volatile("" ::: "memory");
+            } while (page->lock != sequence);
+            sample.values[i] = count;
+            if (i == leaderIndex) {
+                sample.timeEnabled = enabled;
+                sample.timeRunning = running;
+            }
+        }
+        sample.viaRdpmc = true;
+        return true;
+#else
+        (void)sample;
+        return false;
+#endif
+    }
+
+    /* 一次 read() 读取整个 group 的原始计数与 enabled / running 时间 */
+    bool ReadGroup(PerfSample& sample) const noexcept {
+#if defined(EXTRA_HAS_PERF_EVENTS)
+        struct GroupValue{
+            uint64_t value;
+            uint64_t id;
+        };
+        struct GroupRead{
+            uint64_t count;
+            uint64_t timeEnabled;
+            uint64_t timeRunning;
+            GroupValue entries[kPerfEventCount];
+        } data {};
+        if (::read(leader, &data, sizeof(data)) <= 0) return false;
+        sample.timeEnabled = data.timeEnabled;
+        sample.timeRunning = data.timeRunning;
+        for (uint64_t entry = 0; entry < data.count && entry < kPerfEventCount; ++entry) {
+            for (size_t i = 0; i < kPerfEventCount; ++i) {
+                if (fds[i] >= 0 && ids[i] == data.entries[entry].id) {
+                    sample.values[i] = data.entries[entry].value;
+                }
+            }
+        }
+        sample.viaRdpmc = false;
+        return true;
+#else
+        (void)sample;
+        return false;
+#endif
+    }
+
+#if defined(EXTRA_HAS_PERF_EVENTS) && (defined(__x86_64__) || defined(__i386__))
+    static uint64_t ReadPmc(uint32_t counter) noexcept {
+        uint32_t low = 0;
+        uint32_t high = 0;
+        asm volatile("rdpmc" : "=a"(low), "=d"(high) : "c"(counter));
+        return (static_cast<uint64_t>(high) << 32) | low;
+    }
+    static uint64_t ReadTsc() noexcept {
+        uint32_t low = 0;
+        uint32_t high = 0;
+        asm volatile("rdtsc" : "=a"(low), "=d"(high));
+        return (static_cast<uint64_t>(high) << 32) | low;
+    }
+#endif
+
+    void Close() noexcept {
+#if defined(EXTRA_HAS_PERF_EVENTS)
+        for (size_t i = 0; i < kPerfEventCount; ++i) {
+            if (pages[i] != nullptr) ::munmap(pages[i], static_cast<size_t>(::sysconf(_SC_PAGESIZE)));
+            if (fds[i] >= 0) ::close(fds[i]);
+            pages[i] = nullptr;
+            fds[i] = -1;
+        }
+#endif
+        leader = -1;
+        leaderIndex = 0;
+        usesRdpmc = false;
+    }
+
+private:
+    int leader { -1 };
+    size_t leaderIndex { 0 };
+    int fds[kPerfEventCount] { -1, -1, -1, -1 };
+    uint64_t ids[kPerfEventCount] { };
+#if defined(EXTRA_HAS_PERF_EVENTS)
+    perf_event_mmap_page* pages[kPerfEventCount] { };
+#endif
+    bool usesRdpmc { false };
+};
+
+/*
+ * @function: 与 SurvivalTime 类似的区间计时, 同时读取当前线程的硬件计数器
+ * @note: 默认构造时开始, Stop() 或析构时结束; Elapsed() 在结束前返回到目前为止的值
+ * @note: 必须在同一线程上开始与结束; 计数器不可用时只记录耗时 (hasCounters 为 false)
+ * @note: 结束时使用与开始时相同的读取方式; 计数器被复用时按区间内 enabled / running 的比例放大
+ * @Usage:
+    Extra::PerfCounters counters;
+    {
+        Extra::PerfScope scope(&counters);
+        Kernel();
+    }
+    Tools::Print(logger, Tools::Level::Normal, "ipc=", counters.Ipc(), " cache misses=", counters.cacheMisses);
+ */
+class PerfScope{
+public:
+    /* result 不为空时, Stop() (或析构) 把结果累加到 *result */
+    explicit PerfScope(PerfCounters* result = nullptr, bool startNow = true) noexcept
+        : result(result){
+        if (startNow) Start();
+    }
+
+    PerfScope(const PerfScope&) = delete;
+    PerfScope& operator=(const PerfScope&) = delete;
+
+    ~PerfScope() noexcept {
+        Stop();
+    }
+
+    void Start() noexcept {
+        if (running) return ;
+        running = true;
+        hasCounters = group.Read(begin);
+        beginTick = TickClock::Now();
+    }
+
+    void Stop() noexcept {
+        if (!running) return ;
+        elapsed = Sample();
+        running = false;
+        if (result != nullptr) *result += elapsed;
+    }
+
+    PerfCounters Elapsed() const noexcept {
+        return running ? Sample() : elapsed;
+    }
+
+private:
+    PerfCounters Sample() const noexcept {
+        const uint64_t endTick = TickClock::Now();
+        PerfSample end;
+        const bool ok = hasCounters && group.Read(end, begin.viaRdpmc);
+        PerfCounters counters;
+        counters.ns = TickClock::ToNs(endTick - beginTick);
+        if (ok) {
+            uint64_t values[kPerfEventCount];
+            PerfCounterGroup::Delta(begin, end, values);
+            counters.hasCounters = true;
+            counters.cycles = values[0];
+            counters.instructions = values[1];
+            counters.cacheMisses = values[2];
+            counters.branchMisses = values[3];
+        }
+        return counters;
+    }
+
+private:
+    PerfCounterGroup& group { PerfCounterGroup::ForThisThread() };
+    PerfCounters* result { nullptr };
+    PerfSample begin;
+    uint64_t beginTick { 0 };
+    PerfCounters elapsed;
+    bool hasCounters { false };
+    bool running { false };
+};
+
+}
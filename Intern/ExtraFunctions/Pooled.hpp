@@ -0,0 +1,258 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <new>
+#include <stdexcept>
+#include <vector>
+
+#include "../Base/Mem/Memory.hpp"
+namespace Extra{
+struct PoolStats{
+    size_t slotSize { 0 };          /* 每个对象占用的字节数 (按对齐取整) */
+    size_t chunks { 0 };            /* 从后端申请的块数 */
+    size_t reservedBytes { 0 };     /* 所有块的总字节数 */
+    size_t centralFree { 0 };       /* 中心池中空闲的槽位, 不含各线程缓存中的 */
+};
+
+namespace Detail{
+/*
+ * 一个类型的中心池: 从后端 (IMemory 或全局 operator new) 按块申请内存, 切成定长的槽位, 空闲槽位组成链表
+ * 线程缓存一次取 / 还一批槽位, 只有这时才加锁
+ */
+class FixedPool{
+    struct FreeSlot{
+        FreeSlot* next;
+    };
+
+public:
+    FixedPool(size_t objectSize, size_t objectAlign)
+        : slotAlign(std::max({ objectAlign, alignof(FreeSlot), alignof(std::max_align_t) })),
+          slotSize(RoundUp(std::max(objectSize, sizeof(FreeSlot)), std::max(objectAlign, alignof(FreeSlot)))),
+          slotsPerChunk(std::max<size_t>(64, kChunkBytes / slotSize)),
+          batchSize(std::clamp<size_t>(kBatchBytes / slotSize, 8, 256)){}
+
+    FixedPool(const FixedPool&) = delete;
+    FixedPool& operator=(const FixedPool&) = delete;
+
+    void SetMemory(BaseLib::Memory::IMemory* backing){
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!chunks.empty()) {
+            throw std::logic_error("Pooled: backing memory must be set before the first allocation");
+        }
+        memory = backing;
+    }
+
+    /* 取出最多 batchSize 个槽位, 以链表返回; count 为实际个数 */
+    void* TakeBatch(uint32_t& count){
+        std::lock_guard<std::mutex> lock(mutex);
+        if (freeList == nullptr) Grow();
+        FreeSlot* head = freeList;
+        FreeSlot* tail = head;
+        count = 1;
+        while (count < batchSize && tail->next != nullptr) {
+            tail = tail->next;
+            ++count;
+        }
+        freeList = tail->next;
+        tail->next = nullptr;
+        freeCount -= count;
+        return head;
+    }
+
+    /* 归还一条链表, tail 为最后一个槽位 */
+    void PutBatch(void* head, void* tail, uint32_t count) noexcept {
+        std::lock_guard<std::mutex> lock(mutex);
+        static_cast<FreeSlot*>(tail)->next = freeList;
+        freeList = static_cast<FreeSlot*>(head);
+        freeCount += count;
+    }
+
+    PoolStats GetStats(){
+        std::lock_guard<std::mutex> lock(mutex);
+        return PoolStats{ slotSize, chunks.size(), chunks.size() * slotsPerChunk * slotSize, freeCount };
+    }
+
+    static void* Next(void* slot) noexcept {
+        return static_cast<FreeSlot*>(slot)->next;
+    }
+    static void SetNext(void* slot, void* next) noexcept {
+        static_cast<FreeSlot*>(slot)->next = static_cast<FreeSlot*>(next);
+    }
+
+    const size_t slotAlign;
+    const size_t slotSize;
+    const size_t slotsPerChunk;
+    const size_t batchSize;
+
+private:
+    static constexpr size_t kChunkBytes = 64 * 1024;
+    static constexpr size_t kBatchBytes = 16 * 1024;
+
+    struct Chunk{
+        void* raw;
+    };
+
+    static size_t RoundUp(size_t value, size_t align) noexcept {
+        return (value + align - 1) / align * align;
+    }
+
+    /* IMemory 没有对齐参数, 多申请 slotAlign 字节后手动对齐 */
+    void Grow(){
+        const size_t bytes = slotsPerChunk * slotSize + slotAlign;
+        void* raw = memory != nullptr ? memory->Allocate(bytes) : ::operator new(bytes);
+        if (raw == nullptr) throw std::bad_alloc();
+        chunks.push_back(Chunk{ raw });
+        char* base = reinterpret_cast<char*>(RoundUp(reinterpret_cast<uintptr_t>(raw), slotAlign));
+        for (size_t i = slotsPerChunk; i-- > 0;) {
+            FreeSlot* slot = reinterpret_cast<FreeSlot*>(base + i * slotSize);
+            slot->next = freeList;
+            freeList = slot;
+        }
+        freeCount += slotsPerChunk;
+    }
+
+private:
+    std::mutex mutex;
+    FreeSlot* freeList { nullptr };
+    size_t freeCount { 0 };
+    std::vector<Chunk> chunks;
+    BaseLib::Memory::IMemory* memory { nullptr };
+};
+
+/* 每个线程每个类型一份, 平凡析构, 线程退出后仍可安全访问 */
+struct PoolThreadCache{
+    void* head { nullptr };
+    uint32_t count { 0 };
+    bool registered { false };
+    bool retired { false };         /* 线程退出时已归还, 之后直接使用中心池 */
+};
+}
+
+/*
+ * @function: 为类提供 operator new / operator delete, 从该类型独占的定长内存池分配
+ * @note: 每个线程缓存一批空闲槽位, 分配与释放通常只是链表的 push / pop; 缓存空了或过多时与中心池交换一批 (加锁)
+ * @note: 可以在任意线程释放, 槽位进入释放线程的缓存; 线程退出时缓存归还中心池
+ * @note: 大小不等于 sizeof(Ty) 的分配 (例如派生类) 与数组 new 使用全局 operator new
+ * @note: SetPoolMemory() 可以让内存池从 BaseLib::Memory::IMemory 申请块, 必须在第一次分配之前调用; 块在进程结束前不归还
+ * @Usage:
+    template <template<typename> typename Extra>
+    class Node : public Extra<Node<Extra>> { ... };
+
+    Node<Extra::Pooled>* node = new Node<Extra::Pooled>();      // 不经过 malloc
+    delete node;
+ */
+template <typename Ty>
+class Pooled{
+public:
+    static void* operator new(size_t size){
+        if (size != sizeof(Ty)) [[unlikely]] return ::operator new(size);
+        return Allocate();
+    }
+    static void* operator new(size_t size, std::align_val_t align){
+        if (size != sizeof(Ty)) [[unlikely]] return ::operator new(size, align);
+        return Allocate();
+    }
+
+    static void operator delete(void* ptr, size_t size) noexcept {
+        if (ptr == nullptr) return ;
+        if (size != sizeof(Ty)) [[unlikely]] return ::operator delete(ptr);
+        Deallocate(ptr);
+    }
+    static void operator delete(void* ptr, size_t size, std::align_val_t align) noexcept {
+        if (ptr == nullptr) return ;
+        if (size != sizeof(Ty)) [[unlikely]] return ::operator delete(ptr, align);
+        Deallocate(ptr);
+    }
+
+    /* 让该类型的内存池从 memory 申请块; 已经分配过时抛出 std::logic_error */
+    static void SetPoolMemory(BaseLib::Memory::IMemory* memory){
+        Pool().SetMemory(memory);
+    }
+
+    static PoolStats GetPoolStats(){
+        return Pool().GetStats();
+    }
+
+private:
+    /* 内存池不析构: 静态析构阶段 (其他全局对象的析构函数中) 仍可能释放对象 */
+    static Detail::FixedPool& Pool(){
+        static Detail::FixedPool* pool = new Detail::FixedPool(sizeof(Ty), alignof(Ty));
+        return *pool;
+    }
+
+    static Detail::PoolThreadCache& Cache() noexcept {
+        thread_local Detail::PoolThreadCache cache;
+        return cache;
+    }
+
+    /* 线程退出时把缓存归还中心池 */
+    struct CacheFlusher{
+        ~CacheFlusher(){
+            Detail::PoolThreadCache& cache = Cache();
+            Flush(cache, cache.count);
+            cache.retired = true;
+        }
+    };
+
+    /* 线程第一次使用该类型的缓存时, 构造 CacheFlusher 以便在线程退出时归还 */
+    static void Register(Detail::PoolThreadCache& cache) noexcept {
+        cache.registered = true;
+        thread_local CacheFlusher flusher;
+        (void)flusher;
+    }
+
+    static void* Allocate(){
+        Detail::PoolThreadCache& cache = Cache();
+        void* slot = cache.head;
+        if (slot == nullptr) [[unlikely]] {
+            if (!cache.registered) Register(cache);
+            uint32_t count = 0;
+            slot = Pool().TakeBatch(count);
+            if (cache.retired) {
+                if (count > 1) Pool().PutBatch(Detail::FixedPool::Next(slot), Last(Detail::FixedPool::Next(slot)), count - 1);
+                return slot;
+            }
+            cache.count = count;
+        }
+        cache.head = Detail::FixedPool::Next(slot);
+        --cache.count;
+        return slot;
+    }
+
+    static void Deallocate(void* ptr) noexcept {
+        Detail::PoolThreadCache& cache = Cache();
+        if (!cache.registered || cache.retired) [[unlikely]] {
+            if (cache.retired) {
+                Pool().PutBatch(ptr, ptr, 1);
+                return ;
+            }
+            Register(cache);
+        }
+        Detail::FixedPool::SetNext(ptr, cache.head);
+        cache.head = ptr;
+        if (++cache.count > 2 * Pool().batchSize) [[unlikely]] {
+            Flush(cache, static_cast<uint32_t>(Pool().batchSize));
+        }
+    }
+
+    /* 把缓存链表头部的 count 个槽位归还中心池 */
+    static void Flush(Detail::PoolThreadCache& cache, uint32_t count) noexcept {
+        if (count == 0) return ;
+        void* head = cache.head;
+        void* tail = head;
+        for (uint32_t i = 1; i < count; ++i) tail = Detail::FixedPool::Next(tail);
+        cache.head = Detail::FixedPool::Next(tail);
+        cache.count -= count;
+        Pool().PutBatch(head, tail, count);
+    }
+
+    static void* Last(void* head) noexcept {
+        while (Detail::FixedPool::Next(head) != nullptr) head = Detail::FixedPool::Next(head);
+        return head;
+    }
+};
+
+}
@@ -0,0 +1,368 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "../Print/PrintTools.hpp"
+#include "TickClock.hpp"
+
+/* EXTRA_PROFILER 为 0 时 PROFILE_ZONE / PROFILE_FUNCTION 不生成任何代码, 见 CMake 选项 ENABLE_PROFILER */
+#if !defined(EXTRA_PROFILER)
+  #define EXTRA_PROFILER 1
+#endif
+
+namespace Extra{
+struct ProfilerOptions{
+    size_t maxEventsPerThread { 1 << 20 };      /* 每个线程一次采集最多记录的 zone 数, 超过的计入 dropped */
+};
+
+namespace Detail{
+struct ProfileEvent{
+    const char* name;
+    uint64_t begin;
+    uint64_t end;
+};
+
+/*
+ * 一个线程的事件缓冲: 定长的块组成的链表, 只有所属线程写入
+ * 写入事件后以 release 发布块内的数量, 导出时只读取已发布的部分, 不需要加锁
+ * 新的一次采集开始后, 由所属线程在下一次写入时复用已有的块
+ */
+class ThreadTrace{
+public:
+    static constexpr size_t kChunkEvents = 4096;
+
+    struct Chunk{
+        ProfileEvent events[kChunkEvents];
+        std::atomic<size_t> size { 0 };
+        std::atomic<Chunk*> next { nullptr };
+    };
+
+    explicit ThreadTrace(uint32_t id) noexcept
+        : id(id) {}
+
+    ThreadTrace(const ThreadTrace&) = delete;
+    ThreadTrace& operator=(const ThreadTrace&) = delete;
+
+    ~ThreadTrace(){
+        Chunk* chunk = head.load(std::memory_order_relaxed);
+        while (chunk != nullptr) {
+            Chunk* next = chunk->next.load(std::memory_order_relaxed);
+            delete chunk;
+            chunk = next;
+        }
+    }
+
+    void Record(const ProfileEvent& event, uint64_t currentSession, size_t maxEvents) noexcept {
+        if (currentSession != session.load(std::memory_order_relaxed)) [[unlikely]] {
+            Reset(currentSession);
+        }
+        if (recorded >= maxEvents || ((tail == nullptr || tailSize == kChunkEvents) && !Advance())) [[unlikely]] {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return ;
+        }
+        tail->events[tailSize] = event;
+        tail->size.store(++tailSize, std::memory_order_release);
+        ++recorded;
+    }
+
+    /* 导出时调用, 遍历已发布的事件 */
+    template <typename Visit>
+    void ForEach(Visit&& visit) const {
+        for (const Chunk* chunk = head.load(std::memory_order_acquire); chunk != nullptr;
+             chunk = chunk->next.load(std::memory_order_acquire)) {
+            const size_t size = chunk->size.load(std::memory_order_acquire);
+            for (size_t i = 0; i < size; ++i) visit(chunk->events[i]);
+            if (size < kChunkEvents) break;
+        }
+    }
+
+    const uint32_t id;
+    std::atomic<uint64_t> session { 0 };
+    std::atomic<size_t> dropped { 0 };
+    std::atomic<bool> exited { false };
+    mutable std::mutex nameMutex;
+    std::string name;
+
+private:
+    void Reset(uint64_t currentSession) noexcept {
+        for (Chunk* chunk = head.load(std::memory_order_relaxed); chunk != nullptr;
+             chunk = chunk->next.load(std::memory_order_relaxed)) {
+            chunk->size.store(0, std::memory_order_release);
+        }
+        tail = nullptr;
+        tailSize = 0;
+        recorded = 0;
+        dropped.store(0, std::memory_order_relaxed);
+        session.store(currentSession, std::memory_order_release);
+    }
+
+    /* 移到下一个块, 没有时分配; 分配失败时返回 false */
+    bool Advance() noexcept {
+        Chunk* next = tail == nullptr ? head.load(std::memory_order_relaxed) : tail->next.load(std::memory_order_relaxed);
+        if (next == nullptr) {
+            next = new (std::nothrow) Chunk;
+            if (next == nullptr) return false;
+            if (tail == nullptr) {
+                head.store(next, std::memory_order_release);
+            } else {
+                tail->next.store(next, std::memory_order_release);
+            }
+        }
+        tail = next;
+        tailSize = 0;
+        return true;
+    }
+
+private:
+    std::atomic<Chunk*> head { nullptr };
+    Chunk* tail { nullptr };                /* 以下只由所属线程访问 */
+    size_t tailSize { 0 };
+    size_t recorded { 0 };
+};
+
+struct ProfilerState{
+    std::atomic<bool> running { false };
+    std::atomic<uint64_t> session { 0 };
+    std::atomic<size_t> maxEvents { 0 };
+    std::atomic<uint64_t> startTicks { 0 };
+    std::mutex mutex;
+    std::vector<std::shared_ptr<ThreadTrace>> traces;
+    uint32_t nextId { 1 };
+};
+
+/* 常量初始化, zone 的热路径上没有静态初始化的 guard */
+inline ProfilerState profilerState;
+
+inline void AppendJsonString(std::string& out, std::string_view text){
+    out.push_back('"');
+    for (const char ch : text) {
+        if (ch == '"' || ch == '\\') {
+            out.push_back('\\');
+            out.push_back(ch);
+        } else if (static_cast<unsigned char>(ch) < 0x20) {
+            out.push_back(' ');
+        } else {
+            out.push_back(ch);
+        }
+    }
+    out.push_back('"');
+}
+}
+
+/*
+ * @function: 基于 RAII zone 的插桩式 profiler, 导出 Chrome trace_event JSON (chrome://tracing, ui.perfetto.dev 都可以打开)
+ * @note: 每个线程写自己的事件缓冲, 没有锁; 一个 zone 的开销是两次 TickClock::Now() 与一次写入 (约 20ns)
+ * @note: 没有在采集时, zone 只有一次 relaxed 读取; 定义 EXTRA_PROFILER=0 时宏完全不生成代码
+ * @note: zone 的名字必须是静态存储的字符串 (字面量), 缓冲中只保存指针
+ * @note: 应在 Stop() 之后导出; 导出与下一次 Start() 不能同时进行
+ * @Usage:
+    Extra::Profiler::Start();
+    {
+        PROFILE_ZONE("Frame");
+        {
+            PROFILE_ZONE("Physics");
+            ...
+        }
+        PROFILE_FUNCTION();
+    }
+    Extra::Profiler::Stop();
+    Extra::Profiler::SaveChromeTrace("frame.json");
+ */
+class Profiler{
+public:
+    /* 开始一次新的采集, 丢弃上一次的事件 */
+    static void Start(ProfilerOptions options = {}) {
+        Detail::ProfilerState& state = Detail::profilerState;
+        std::lock_guard<std::mutex> lock(state.mutex);
+        /* 已经退出的线程的事件只保留到下一次采集 */
+        std::erase_if(state.traces, [](const std::shared_ptr<Detail::ThreadTrace>& trace){
+            return trace->exited.load(std::memory_order_acquire);
+        });
+        state.maxEvents.store(options.maxEventsPerThread, std::memory_order_relaxed);
+        state.startTicks.store(TickClock::Now(), std::memory_order_relaxed);
+        state.session.fetch_add(1, std::memory_order_relaxed);
+        state.running.store(true, std::memory_order_release);
+    }
+
+    static void Stop() noexcept {
+        Detail::profilerState.running.store(false, std::memory_order_release);
+    }
+
+    static bool IsRunning() noexcept {
+        return Detail::profilerState.running.load(std::memory_order_relaxed);
+    }
+
+    /* 当前线程在 trace 中显示的名字 */
+    static void SetThreadName(std::string name) {
+        Detail::ThreadTrace& trace = LocalTrace();
+        std::lock_guard<std::mutex> lock(trace.nameMutex);
+        trace.name = std::move(name);
+    }
+
+    static void Record(const char* name, uint64_t begin, uint64_t end) noexcept {
+        const Detail::ProfilerState& state = Detail::profilerState;
+        LocalTrace().Record(Detail::ProfileEvent{ name, begin, end }, state.session.load(std::memory_order_relaxed),
+                            state.maxEvents.load(std::memory_order_relaxed));
+    }
+
+    /* 本次采集记录的事件数与因为超过上限而丢弃的数量 */
+    static size_t GetEventCount() {
+        size_t count = 0;
+        ForEachTrace([&](const Detail::ThreadTrace& trace){
+            trace.ForEach([&](const Detail::ProfileEvent&){ ++count; });
+        });
+        return count;
+    }
+    static size_t GetDroppedCount() {
+        size_t count = 0;
+        ForEachTrace([&](const Detail::ThreadTrace& trace){
+            count += trace.dropped.load(std::memory_order_relaxed);
+        });
+        return count;
+    }
+
+    /*
+     * @function: 把本次采集追加为 Chrome trace_event JSON
+     * @note: 每个 zone 是一个 "X" (complete) 事件, ts / dur 的单位是微秒, 从 Start() 开始计时; 线程名是 "M" 元数据事件
+     */
+    static void AppendChromeTrace(std::string& out) {
+        const uint64_t startTicks = Detail::profilerState.startTicks.load(std::memory_order_relaxed);
+        const double usPerTick = TickClock::NsPerTick() / 1000.0;
+        bool first = true;
+        auto separator = [&]{
+            out += first ? "\n" : ",\n";
+            first = false;
+        };
+        out += "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+        ForEachTrace([&](const Detail::ThreadTrace& trace){
+            {
+                std::lock_guard<std::mutex> lock(trace.nameMutex);
+                separator();
+                out += "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":";
+                Tools::AppendTo(out, trace.id);
+                out += ",\"args\":{\"name\":";
+                if (trace.name.empty()) {
+                    std::string name = "thread ";
+                    Tools::AppendTo(name, trace.id);
+                    Detail::AppendJsonString(out, name);
+                } else {
+                    Detail::AppendJsonString(out, trace.name);
+                }
+                out += "}}";
+            }
+            trace.ForEach([&](const Detail::ProfileEvent& event){
+                /* 跨越 Start() 的 zone 只保留 Start() 之后的部分 */
+                if (event.end < startTicks) return ;
+                const uint64_t begin = event.begin < startTicks ? startTicks : event.begin;
+                separator();
+                out += "{\"name\":";
+                Detail::AppendJsonString(out, event.name);
+                out += ",\"ph\":\"X\",\"pid\":1,\"tid\":";
+                Tools::AppendTo(out, trace.id);
+                out += ",\"ts\":";
+                Tools::AppendTo(out, static_cast<double>(begin - startTicks) * usPerTick);
+                out += ",\"dur\":";
+                Tools::AppendTo(out, static_cast<double>(event.end - begin) * usPerTick);
+                out += "}";
+            });
+        });
+        out += "\n]}\n";
+    }
+
+    static void WriteChromeTrace(std::ostream& stream) {
+        std::string json;
+        AppendChromeTrace(json);
+        stream.write(json.data(), static_cast<std::streamsize>(json.size()));
+    }
+
+    static bool SaveChromeTrace(const std::string& path) {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        if (!file) return false;
+        WriteChromeTrace(file);
+        return static_cast<bool>(file);
+    }
+
+private:
+    /* 线程结束时只做标记, 事件保留到下一次 Start() */
+    struct ThreadSlot{
+        std::shared_ptr<Detail::ThreadTrace> trace;
+        ~ThreadSlot(){
+            trace->exited.store(true, std::memory_order_release);
+        }
+    };
+
+    static Detail::ThreadTrace& LocalTrace() noexcept {
+        /* 常量初始化的指针, 常规路径上没有 thread_local 的初始化检查 */
+        thread_local Detail::ThreadTrace* cached = nullptr;
+        if (cached == nullptr) [[unlikely]] {
+            cached = &RegisterThread();
+        }
+        return *cached;
+    }
+
+    static Detail::ThreadTrace& RegisterThread() {
+        Detail::ProfilerState& state = Detail::profilerState;
+        std::lock_guard<std::mutex> lock(state.mutex);
+        thread_local ThreadSlot slot;
+        slot.trace = std::make_shared<Detail::ThreadTrace>(state.nextId++);
+        state.traces.push_back(slot.trace);
+        return *slot.trace;
+    }
+
+    /* 只访问本次采集中写入过事件的线程 */
+    template <typename Visit>
+    static void ForEachTrace(Visit&& visit) {
+        Detail::ProfilerState& state = Detail::profilerState;
+        std::lock_guard<std::mutex> lock(state.mutex);
+        const uint64_t session = state.session.load(std::memory_order_relaxed);
+        for (const auto& trace : state.traces) {
+            if (trace->session.load(std::memory_order_acquire) == session) visit(*trace);
+        }
+    }
+};
+
+/*
+ * @function: RAII 的 zone, 构造到析构之间的时间记为一个事件; 通常通过 PROFILE_ZONE 使用
+ * @note: 只有构造时正在采集, 析构时才会记录
+ */
+class ProfileZone{
+public:
+    explicit ProfileZone(const char* name) noexcept
+        : name(name), begin(Profiler::IsRunning() ? TickClock::Now() : 0) {}
+
+    ProfileZone(const ProfileZone&) = delete;
+    ProfileZone& operator=(const ProfileZone&) = delete;
+
+    ~ProfileZone(){
+        if (begin != 0) {
+            Profiler::Record(name, begin, TickClock::Now());
+        }
+    }
+
+private:
+    const char* name;
+    uint64_t begin;
+};
+
+}
+
+#define EXTRA_PROFILE_CONCAT_IMPL_(a, b) a##b
+#define EXTRA_PROFILE_CONCAT_(a, b) EXTRA_PROFILE_CONCAT_IMPL_(a, b)
+
+#if EXTRA_PROFILER
+  #define PROFILE_ZONE(name) ::Extra::ProfileZone EXTRA_PROFILE_CONCAT_(extraProfileZone_, __LINE__)(name)
+  #define PROFILE_FUNCTION() PROFILE_ZONE(__func__)
+#else
+  #define PROFILE_ZONE(name) ((void)0)
+  #define PROFILE_FUNCTION() ((void)0)
+#endif
@@ -0,0 +1,225 @@
+#pragma once
+
+#include <atomic>
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <type_traits>
+#include <utility>
+
+namespace Extra{
+/*
+ * @function: RefCounted 的默认计数策略, 原子计数, 对象可以在线程之间共享
+ * @note: 增加引用用 relaxed, 减少用 acq_rel, 保证析构看到其他线程释放引用之前的所有写入
+ */
+struct AtomicRefCount{
+    /* 对象尚未共享时设置第一个引用, 普通的 store */
+    void InitializeFirst() noexcept {
+        count.store(1, std::memory_order_relaxed);
+    }
+    void Increment() noexcept {
+        count.fetch_add(1, std::memory_order_relaxed);
+    }
+    /* 返回 true 表示这是最后一个引用 */
+    bool Decrement() noexcept {
+        return count.fetch_sub(1, std::memory_order_acq_rel) == 1;
+    }
+    uint32_t Load() const noexcept {
+        return count.load(std::memory_order_relaxed);
+    }
+
+    std::atomic<uint32_t> count { 0 };
+};
+
+/*
+ * @function: 非原子的计数策略, 只能用于不跨线程共享的对象, 增减引用只是普通的加减
+ */
+struct PlainRefCount{
+    void InitializeFirst() noexcept {
+        count = 1;
+    }
+    void Increment() noexcept {
+        ++count;
+    }
+    bool Decrement() noexcept {
+        return --count == 0;
+    }
+    uint32_t Load() const noexcept {
+        return count;
+    }
+
+    uint32_t count { 0 };
+};
+
+/*
+ * @function: 侵入式引用计数, 计数器嵌在对象中, 与 IntrusivePtr 一起使用
+ * @note: 与 std::shared_ptr 相比没有控制块 (没有额外的分配), 句柄只有一个指针; PlainRefCount 时增减引用没有原子操作
+ * @note: 最后一个引用释放时 delete 对象 (使用 Ty 的 operator delete, 可以与 Pooled 组合); 通过基类指针释放派生类时基类需要虚析构函数
+ * @note: 拷贝对象不拷贝计数, 新对象的计数从 0 开始
+ * @note: 作为模板模板参数时使用只有一个参数的别名 RefCounted / LocalRefCounted (Clang 19 之前没有实现 P0522)
+ * @Usage:
+    template <template<typename> typename... Extras>
+    class Texture : public Extras<Texture<Extras...>>... { ... };
+
+    using SharedTexture = Texture<Extra::RefCounted>;
+    Extra::IntrusivePtr<SharedTexture> texture = Extra::MakeIntrusive<SharedTexture>();
+    auto other = texture;               // 引用数 2
+ */
+template <typename Ty, typename Policy>
+class BasicRefCounted{
+public:
+    void ExtraAddRef() const noexcept {
+        refCount.Increment();
+    }
+
+    /* 只能在新构造, 尚未被任何 IntrusivePtr 持有的对象上调用, 省去一次原子操作; MakeIntrusive 使用 */
+    void ExtraAddFirstRef() const noexcept {
+        refCount.InitializeFirst();
+    }
+
+    void ExtraRelease() const noexcept {
+        if (refCount.Decrement()) {
+            delete static_cast<const Ty*>(this);
+        }
+    }
+
+    uint32_t ExtraUseCount() const noexcept {
+        return refCount.Load();
+    }
+
+protected:
+    BasicRefCounted() noexcept = default;
+    BasicRefCounted(const BasicRefCounted&) noexcept {}
+    BasicRefCounted& operator=(const BasicRefCounted&) noexcept {
+        return *this;
+    }
+    ~BasicRefCounted() = default;
+
+private:
+    mutable Policy refCount;
+};
+
+/* 原子计数, 可以直接作为模板模板参数 */
+template <typename Ty>
+using RefCounted = BasicRefCounted<Ty, AtomicRefCount>;
+
+/* 非原子计数的别名, 可以直接作为模板模板参数 */
+template <typename Ty>
+using LocalRefCounted = BasicRefCounted<Ty, PlainRefCount>;
+
+/*
+ * @function: 指向 RefCounted 对象的句柄, 拷贝增加引用, 析构减少引用
+ * @note: 移动只转移指针, 不修改计数; sizeof(IntrusivePtr) == sizeof(void*)
+ * @note: 可以从裸指针构造 (对象自身带有计数, 不会像 shared_ptr 那样产生两个控制块); Detach() 交出所有权而不减少引用
+ */
+template <typename Ty>
+class IntrusivePtr{
+public:
+    IntrusivePtr() noexcept = default;
+    IntrusivePtr(std::nullptr_t) noexcept {}
+
+    /* addRef 为 false 时接管一个已经计入的引用 (例如 Detach() 的结果) */
+    explicit IntrusivePtr(Ty* ptr, bool addRef = true) noexcept
+        : ptr(ptr){
+        if (ptr != nullptr && addRef) ptr->ExtraAddRef();
+    }
+
+    IntrusivePtr(const IntrusivePtr& other) noexcept
+        : ptr(other.ptr){
+        if (ptr != nullptr) ptr->ExtraAddRef();
+    }
+    IntrusivePtr(IntrusivePtr&& other) noexcept
+        : ptr(std::exchange(other.ptr, nullptr)){}
+
+    template <typename Other, typename = std::enable_if_t<std::is_convertible_v<Other*, Ty*>>>
+    IntrusivePtr(const IntrusivePtr<Other>& other) noexcept
+        : ptr(other.Get()){
+        if (ptr != nullptr) ptr->ExtraAddRef();
+    }
+    template <typename Other, typename = std::enable_if_t<std::is_convertible_v<Other*, Ty*>>>
+    IntrusivePtr(IntrusivePtr<Other>&& other) noexcept
+        : ptr(other.Detach()){}
+
+    ~IntrusivePtr(){
+        if (ptr != nullptr) ptr->ExtraRelease();
+    }
+
+    IntrusivePtr& operator=(const IntrusivePtr& other) noexcept {
+        IntrusivePtr(other).Swap(*this);
+        return *this;
+    }
+    IntrusivePtr& operator=(IntrusivePtr&& other) noexcept {
+        IntrusivePtr(std::move(other)).Swap(*this);
+        return *this;
+    }
+    IntrusivePtr& operator=(std::nullptr_t) noexcept {
+        Reset();
+        return *this;
+    }
+
+    void Reset() noexcept {
+        IntrusivePtr().Swap(*this);
+    }
+    void Reset(Ty* other, bool addRef = true) noexcept {
+        IntrusivePtr(other, addRef).Swap(*this);
+    }
+
+    /* 交出所有权: 返回指针并置空, 不减少引用 */
+    [[nodiscard]] Ty* Detach() noexcept {
+        return std::exchange(ptr, nullptr);
+    }
+
+    void Swap(IntrusivePtr& other) noexcept {
+        std::swap(ptr, other.ptr);
+    }
+
+    Ty* Get() const noexcept {
+        return ptr;
+    }
+    Ty& operator*() const noexcept {
+        return *ptr;
+    }
+    Ty* operator->() const noexcept {
+        return ptr;
+    }
+    explicit operator bool() const noexcept {
+        return ptr != nullptr;
+    }
+
+    uint32_t UseCount() const noexcept {
+        return ptr != nullptr ? ptr->ExtraUseCount() : 0;
+    }
+
+    template <typename Other>
+    bool operator==(const IntrusivePtr<Other>& other) const noexcept {
+        return ptr == other.Get();
+    }
+    bool operator==(std::nullptr_t) const noexcept {
+        return ptr == nullptr;
+    }
+    template <typename Other>
+    std::strong_ordering operator<=>(const IntrusivePtr<Other>& other) const noexcept {
+        return std::compare_three_way{}(ptr, other.Get());
+    }
+
+private:
+    Ty* ptr { nullptr };
+};
+
+/* 构造对象并返回持有一个引用的 IntrusivePtr */
+template <typename Ty, typename... Args>
+IntrusivePtr<Ty> MakeIntrusive(Args&&... args){
+    Ty* object = new Ty(std::forward<Args>(args)...);
+    object->ExtraAddFirstRef();
+    return IntrusivePtr<Ty>(object, false);
+}
+
+}
+
+template <typename Ty>
+struct std::hash<Extra::IntrusivePtr<Ty>>{
+    size_t operator()(const Extra::IntrusivePtr<Ty>& ptr) const noexcept {
+        return std::hash<Ty*>{}(ptr.Get());
+    }
+};
@@ -0,0 +1,196 @@
+#pragma once
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <mutex>
+
+#include "TickClock.hpp"
+namespace Extra{
+/* 与 TickClock 接口相同的 steady_clock, tick 即纳秒 */
+struct SteadyTickClock{
+    static uint64_t Now() noexcept {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+    static double NsPerTick() noexcept {
+        return 1.0;
+    }
+    static double ToNs(uint64_t ticks) noexcept {
+        return static_cast<double>(ticks);
+    }
+};
+
+/* 所有圈的统计, 单位纳秒; variance 为样本方差 (n - 1), 少于两圈时为 0 */
+struct LapStats{
+    uint64_t count { 0 };
+    double totalNs { 0.0 };
+    double meanNs { 0.0 };
+    double minNs { 0.0 };
+    double maxNs { 0.0 };
+    double varianceNs2 { 0.0 };
+
+    double StdDevNs() const noexcept {
+        return std::sqrt(varianceNs2);
+    }
+};
+
+namespace Detail{
+struct NoLock{
+    void lock() noexcept {}
+    void unlock() noexcept {}
+};
+}
+
+/*
+ * @function: 可以反复开始 / 停止的秒表, 每一圈的耗时以 Welford 算法累计均值, 方差, 最小与最大值
+ * @note: Clock 为 TickClock (默认, 可用时为校准过的 TSC) 或 SteadyTickClock; 统计以 tick 累计, GetStats() 时才换算为纳秒
+ * @note: Lock 为 std::mutex 时 (Stopwatch) 可以在多个线程上使用; Detail::NoLock 时 (LocalStopwatch) 只能在一个线程上使用, 没有原子操作
+ * @note: 多个线程同时计时时各自用 ScopedLap (自己保存开始时刻), 只有 AddLapTicks() 共享
+ * @Usage:
+    Extra::LocalStopwatch<> stopwatch;
+    stopwatch.Start();
+    for (auto& item : items) {
+        Process(item);
+        stopwatch.Lap();            // 记录这一圈并立即开始下一圈, 只读一次时钟
+    }
+    stopwatch.Stop();
+    const Extra::LapStats stats = stopwatch.GetStats();
+ */
+template <typename Clock = TickClock, typename Lock = std::mutex>
+class BasicStopwatch{
+public:
+    BasicStopwatch() = default;
+    BasicStopwatch(const BasicStopwatch&) = delete;
+    BasicStopwatch& operator=(const BasicStopwatch&) = delete;
+
+    /* 开始一圈; 已经在计时时重新开始当前圈, 不记录 */
+    void Start() noexcept {
+        const uint64_t now = Clock::Now();
+        std::lock_guard<Lock> guard(lock);
+        lapStart = now;
+        running = true;
+    }
+
+    /* 结束当前圈并记录, 返回这一圈的纳秒数; 没有在计时时返回 0 */
+    double Stop() noexcept {
+        const uint64_t now = Clock::Now();
+        std::lock_guard<Lock> guard(lock);
+        if (!running) return 0.0;
+        running = false;
+        const uint64_t ticks = now - lapStart;
+        Accumulate(ticks);
+        return Clock::ToNs(ticks);
+    }
+
+    /* 记录当前圈并以同一时刻开始下一圈; 没有在计时时只开始计时. 不返回耗时, 避免每圈换算 */
+    void Lap() noexcept {
+        const uint64_t now = Clock::Now();
+        std::lock_guard<Lock> guard(lock);
+        if (running) Accumulate(now - lapStart);
+        lapStart = now;
+        running = true;
+    }
+
+    /* 记录一圈外部测量的耗时 (tick) */
+    void AddLapTicks(uint64_t ticks) noexcept {
+        std::lock_guard<Lock> guard(lock);
+        Accumulate(ticks);
+    }
+
+    /* 当前圈到目前为止的纳秒数, 没有在计时时为 0 */
+    double ElapsedNs() const noexcept {
+        const uint64_t now = Clock::Now();
+        std::lock_guard<Lock> guard(lock);
+        return running ? Clock::ToNs(now - lapStart) : 0.0;
+    }
+
+    bool IsRunning() const noexcept {
+        std::lock_guard<Lock> guard(lock);
+        return running;
+    }
+
+    uint64_t GetLapCount() const noexcept {
+        std::lock_guard<Lock> guard(lock);
+        return count;
+    }
+
+    LapStats GetStats() const noexcept {
+        std::lock_guard<Lock> guard(lock);
+        LapStats stats;
+        stats.count = count;
+        if (count == 0) return stats;
+        const double nsPerTick = Clock::NsPerTick();
+        stats.totalNs = Clock::ToNs(totalTicks);
+        stats.meanNs = mean * nsPerTick;
+        stats.minNs = Clock::ToNs(minTicks);
+        stats.maxNs = Clock::ToNs(maxTicks);
+        stats.varianceNs2 = count > 1 ? m2 / static_cast<double>(count - 1) * nsPerTick * nsPerTick : 0.0;
+        return stats;
+    }
+
+    /* 清空统计并停止计时 */
+    void Reset() noexcept {
+        std::lock_guard<Lock> guard(lock);
+        running = false;
+        count = 0;
+        totalTicks = 0;
+        mean = 0.0;
+        m2 = 0.0;
+        minTicks = std::numeric_limits<uint64_t>::max();
+        maxTicks = 0;
+    }
+
+private:
+    void Accumulate(uint64_t ticks) noexcept {
+        ++count;
+        totalTicks += ticks;
+        const double value = static_cast<double>(ticks);
+        const double delta = value - mean;
+        mean += delta / static_cast<double>(count);
+        m2 += delta * (value - mean);
+        if (ticks < minTicks) minTicks = ticks;
+        if (ticks > maxTicks) maxTicks = ticks;
+    }
+
+private:
+    mutable Lock lock;
+    uint64_t lapStart { 0 };
+    bool running { false };
+    uint64_t count { 0 };
+    uint64_t totalTicks { 0 };
+    double mean { 0.0 };            /* tick */
+    double m2 { 0.0 };              /* 与均值之差的平方和, tick^2 */
+    uint64_t minTicks { std::numeric_limits<uint64_t>::max() };
+    uint64_t maxTicks { 0 };
+};
+
+template <typename Clock = TickClock>
+using Stopwatch = BasicStopwatch<Clock, std::mutex>;
+
+template <typename Clock = TickClock>
+using LocalStopwatch = BasicStopwatch<Clock, Detail::NoLock>;
+
+/*
+ * @function: 把作用域的耗时作为一圈记录到秒表, 开始时刻保存在自身, 多个线程可以同时对同一个 Stopwatch 计时
+ */
+template <typename Clock, typename Lock>
+class ScopedLap{
+public:
+    explicit ScopedLap(BasicStopwatch<Clock, Lock>& stopwatch) noexcept
+        : stopwatch(stopwatch), start(Clock::Now()){}
+
+    ScopedLap(const ScopedLap&) = delete;
+    ScopedLap& operator=(const ScopedLap&) = delete;
+
+    ~ScopedLap(){
+        stopwatch.AddLapTicks(Clock::Now() - start);
+    }
+
+private:
+    BasicStopwatch<Clock, Lock>& stopwatch;
+    uint64_t start;
+};
+
+}
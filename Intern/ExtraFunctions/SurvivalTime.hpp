@@ -7,16 +7,16 @@ template <typename Ty>
 class SurvivalTime {
 public:
     SurvivalTime() noexcept
-        : is_started_(false), is_stopped_(false), running_(false), elapsed_time_(0.0)
+        : is_started_(false), is_stopped_(false), elapsed_time_(0.0), running_(false)
     {
-        StartTimekeeping();
+        ExtraStartTimekeeping();
     }
 
     SurvivalTime(bool is_start_now) noexcept
-        : is_started_(is_start_now), is_stopped_(false), running_(false), elapsed_time_(0.0)
+        : is_started_(false), is_stopped_(false), elapsed_time_(0.0), running_(false)
     {
         if (is_start_now) {
-            StartTimekeeping();
+            ExtraStartTimekeeping();
         }
     }
 
@@ -26,7 +26,7 @@ public:
 
     // 析构时自动停止计时
     ~SurvivalTime() noexcept {
-        StopTimekeeping();
+        ExtraStopTimekeeping();
     }
 
     // 手动开始计时（只能调用一次）
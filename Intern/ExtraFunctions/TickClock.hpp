@@ -0,0 +1,41 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+#include "../Print/Timestamp.hpp"
+namespace Extra{
+/*
+ * @function: 用于测量耗时的廉价时钟, 返回原始的 tick
+ * @note: x86 上 TSC 是 invariant 时直接读 rdtsc (约 20 个周期), 频率复用 Tools::WallClock 的校准结果; 否则使用 steady_clock 的纳秒数
+ * @note: tick 只用于求差值, 用 ToNs() 换算; 不同进程之间的 tick 没有可比性
+ */
+class TickClock{
+public:
+    static uint64_t Now() noexcept {
+#if defined(TOOLS_HAS_TSC)
+        if (UsesTsc()) [[likely]] {
+            return __rdtsc();
+        }
+#endif
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    static bool UsesTsc() noexcept {
+        return Tools::WallClock::UsesTsc();
+    }
+
+    static double NsPerTick() noexcept {
+#if defined(TOOLS_HAS_TSC)
+        if (UsesTsc()) return Tools::WallClock::Calibrate().nsPerTick;
+#endif
+        return 1.0;
+    }
+
+    static double ToNs(uint64_t ticks) noexcept {
+        return static_cast<double>(ticks) * NsPerTick();
+    }
+};
+
+}
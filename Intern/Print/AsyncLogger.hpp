@@ -0,0 +1,369 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "../Concurrency/SPSCRing.hpp"
+#include "DeferredFormat.hpp"
+#include "LineWriter.hpp"
+#include "LogSink.hpp"
+#include "Printable.hpp"
+
+namespace Tools{
+/*
+ * @function: 线程队列满时的处理方式
+ * @Block: 等待后台线程腾出空间 (不丢日志, 调用方可能被阻塞)
+ * @Drop: 直接丢弃
+ * @DropAndCount: 丢弃并计数, 后台线程在该线程的下一条日志之前输出丢弃的数量
+ */
+enum class OverflowPolicy{
+    Block, Drop, DropAndCount
+};
+
+/*
+ * @function: 在哪个线程上把参数转换为文本
+ * @Eager: 调用线程上格式化, 队列里是文本
+ * @Deferred: 调用线程只拷贝参数的原始字节, 后台线程格式化; 含有不能延迟的参数时退回 Eager
+ */
+enum class FormatMode{
+    Eager, Deferred
+};
+
+struct AsyncLoggerOptions{
+    size_t queueBytes { 1 << 16 };                          /* 每个线程的队列字节数, 向上取整为 2 的幂 */
+    OverflowPolicy overflow { OverflowPolicy::Block };
+    std::chrono::milliseconds flushInterval { 10 };         /* 空闲时后台线程的最长睡眠时间 */
+    FormatMode format { FormatMode::Eager };
+    bool reportDrops { true };                              /* 是否在输出中写入 "dropped N messages", 二进制输出需要关闭 */
+};
+
+namespace Detail{
+/*
+ * 队列中的一条记录: [RecordHeader | payload]
+ * 后台线程调用 render 把 payload 追加成文本, 调用方只负责拷贝字节
+ */
+using RenderFn = void (*)(const char* payload, size_t size, std::string& out);
+
+struct RecordHeader{
+    RenderFn render { nullptr };
+    uint32_t size { 0 };
+};
+
+inline void RenderText(const char* payload, size_t size, std::string& out){
+    out.append(payload, size);
+}
+
+struct ProducerQueue{
+    explicit ProducerQueue(size_t bytes)
+        : ring(bytes) {}
+
+    Concurrency::SPSCRing<char> ring;
+    std::atomic<uint64_t> dropped { 0 };
+    std::atomic<bool> closed { false };     /* 生产线程已退出, 读空后移除 */
+    std::atomic<bool> retired { false };    /* logger 已停止, 生产线程下次查找时释放自己的引用 */
+};
+}
+
+/*
+ * @function: 异步日志后端
+ * @note: 每个线程第一次写日志时注册一个 SPSC 字节队列, 调用方只做格式化 + 一次 memcpy 入队
+ * @note: 后台线程轮流读空所有线程队列, 拼成一个批次后一次写入 sink 并 flush
+ * @note: 同一线程的日志保持顺序, 不同线程之间不保证全局顺序
+ * @note: 单条记录超过队列容量时总是被丢弃并计数
+ * @note: FormatMode::Deferred 下调用方连格式化都不做, 只拷贝参数字节, 见 DeferredFormat.hpp
+ * @Usage:
+    Tools::AsyncLogger logger(std::cout, { .overflow = Tools::OverflowPolicy::DropAndCount });
+    Tools::Print(logger, Tools::Level::Normal, "frame ", frameIndex, " done");
+    logger.Flush();     // 可选, 析构时也会写完剩余日志
+ */
+class AsyncLogger{
+public:
+    explicit AsyncLogger(std::ostream& stream, AsyncLoggerOptions options = {})
+        : ownedSink(std::make_unique<OstreamSink>(stream)), sink(*ownedSink), options(options), id(NextId()){
+        writer = std::thread([this]{ WriterLoop(); });
+    }
+
+    /* 写入任意 sink (FileSink / FdSink / ...), sink 的生命周期必须长于 logger */
+    explicit AsyncLogger(ILogSink& sink, AsyncLoggerOptions options = {})
+        : sink(sink), options(options), id(NextId()){
+        writer = std::thread([this]{ WriterLoop(); });
+    }
+
+    AsyncLogger(const AsyncLogger&) = delete;
+    AsyncLogger& operator=(const AsyncLogger&) = delete;
+
+    ~AsyncLogger(){
+        Stop();
+    }
+
+    /* 把参数拼接成一行并入队, 返回是否入队; 按 options.format 决定在哪个线程上格式化 */
+    template <typename... Args>
+    bool Log(Level level, const Args&... args){
+        if constexpr (Detail::kAllDeferrable<Args...>) {
+            if (options.format == FormatMode::Deferred) {
+                return Emit(level, &Detail::RenderConcat<Args...>, [&](Detail::LineWriter& writer){
+                    Detail::EncodeArgs(writer.record, args...);
+                });
+            }
+        }
+        return Emit(level, &Detail::RenderText, [&](Detail::LineWriter& writer){
+            (Detail::AppendArg(writer.record, args), ...);
+            writer.record.push_back('\n');
+        });
+    }
+
+    /*
+     * @function: 格式串风格的日志, 总是在后台线程上格式化
+     * @param: format 必须是字符串字面量, 队列里只保存它的地址; 格式串在编译期检查
+     * @note: 参数必须都可以延迟 (算术类型与字符串)
+     */
+    template <typename... Args>
+    bool LogFormat(Level level, Detail::FormatLiteral<Args...> format, const Args&... args){
+        static_assert(Detail::kAllDeferrable<Args...>, "LogFormat arguments must be arithmetic or string types");
+        return Emit(level, &Detail::RenderFormat<Args...>, [&](Detail::LineWriter& writer){
+            Detail::EncodeFormat(writer.record, format.text, args...);
+        });
+    }
+
+    /*
+     * @function: 入队一条自定义记录
+     * @param: render 在后台线程上把 payload 转换为文本
+     * @param: fill 向 LineWriter::record 追加 payload 字节 (或写入 LineWriter::stream)
+     */
+    template <typename Fill>
+    bool Emit([[maybe_unused]] Level level, Detail::RenderFn render, Fill&& fill){
+        if (stopped.load(std::memory_order_relaxed)) return false;
+        Detail::LineWriter& writer = Detail::LocalLineWriter();
+        writer.record.resize(sizeof(Detail::RecordHeader));
+        fill(writer);
+
+        Detail::RecordHeader header;
+        header.render = render;
+        header.size = static_cast<uint32_t>(writer.record.size() - sizeof(Detail::RecordHeader));
+        std::memcpy(writer.record.data(), &header, sizeof(header));
+        return Enqueue(writer.record.data(), writer.record.size());
+    }
+
+    /* 阻塞直到调用之前入队的日志全部写入 sink 并 flush */
+    void Flush(){
+        if (stopped.load(std::memory_order_acquire)) return ;
+        const uint64_t ticket = flushRequests.fetch_add(1, std::memory_order_acq_rel) + 1;
+        Wake();
+        for (uint64_t done = flushed.load(std::memory_order_acquire); done < ticket;
+             done = flushed.load(std::memory_order_acquire)) {
+            flushed.wait(done, std::memory_order_acquire);
+        }
+    }
+
+    /* 写完所有已入队的日志后停止后台线程, 之后的日志会被丢弃; 各线程的队列在它们下次写日志 (任意 logger) 时释放 */
+    void Stop(){
+        if (stopped.exchange(true, std::memory_order_acq_rel)) return ;
+        Wake();
+        writer.join();
+        std::lock_guard<std::mutex> lock(queuesMutex);
+        for (auto& queue : queues) {
+            queue->retired.store(true, std::memory_order_relaxed);
+        }
+        queues.clear();
+    }
+
+    /* DropAndCount 以及超长记录丢弃的总数 */
+    uint64_t GetDroppedCount() const noexcept{
+        return droppedTotal.load(std::memory_order_relaxed);
+    }
+
+    /* sink 的 Write / Flush 抛出异常 (例如 FdSink 遇到 EPIPE / ENOSPC) 的次数, 失败的那一批日志被丢弃 */
+    uint64_t GetFailedWriteCount() const noexcept{
+        return failedWrites.load(std::memory_order_relaxed);
+    }
+
+private:
+    static uint64_t NextId() noexcept{
+        static std::atomic<uint64_t> counter { 0 };
+        return counter.fetch_add(1, std::memory_order_relaxed) + 1;
+    }
+
+    /* 线程退出时把自己的队列标记为关闭; 已停止的 logger 的队列在查找时移除, 不会随线程一直保留 */
+    struct LocalQueues{
+        ~LocalQueues(){
+            for (auto& entry : entries) {
+                entry.second->closed.store(true, std::memory_order_release);
+            }
+        }
+        std::vector<std::pair<uint64_t, std::shared_ptr<Detail::ProducerQueue>>> entries;
+    };
+
+    Detail::ProducerQueue& LocalQueue(){
+        thread_local LocalQueues locals;
+        auto& entries = locals.entries;
+        for (size_t i = 0; i < entries.size();) {
+            if (entries[i].second->retired.load(std::memory_order_relaxed)) {
+                entries[i] = std::move(entries.back());
+                entries.pop_back();
+                continue;
+            }
+            if (entries[i].first == id) return *entries[i].second;
+            ++i;
+        }
+        auto queue = std::make_shared<Detail::ProducerQueue>(options.queueBytes);
+        {
+            std::lock_guard<std::mutex> lock(queuesMutex);
+            /* 与 Stop 竞争时 (已经看过 stopped) 不再登记, 这个队列不会被读取, 下次查找时释放 */
+            if (stopped.load(std::memory_order_relaxed)) {
+                queue->retired.store(true, std::memory_order_relaxed);
+            } else {
+                queues.push_back(queue);
+            }
+        }
+        locals.entries.emplace_back(id, queue);
+        return *queue;
+    }
+
+    bool Enqueue(const char* record, size_t bytes){
+        Detail::ProducerQueue& queue = LocalQueue();
+        if (bytes > queue.ring.Capacity()) {
+            CountDrop(queue);
+            return false;
+        }
+        /* 生产者看到的空闲空间只会偏小, 满足条件时 PushN 一定能一次写完整条记录 */
+        while (queue.ring.Capacity() - queue.ring.ApproxSize() < bytes) {
+            if (options.overflow == OverflowPolicy::Drop) return false;
+            if (options.overflow == OverflowPolicy::DropAndCount) {
+                CountDrop(queue);
+                return false;
+            }
+            if (stopped.load(std::memory_order_relaxed)) return false;
+            Wake();
+            std::this_thread::yield();
+        }
+        queue.ring.PushN(record, bytes);
+        return true;
+    }
+
+    void CountDrop(Detail::ProducerQueue& queue) noexcept{
+        queue.dropped.fetch_add(1, std::memory_order_relaxed);
+        droppedTotal.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void Wake(){
+        {
+            std::lock_guard<std::mutex> lock(wakeMutex);
+            wakeRequested = true;
+        }
+        wakeCv.notify_one();
+    }
+
+    /* 读空所有队列, 把渲染后的文本追加到 batch, 返回是否读到了内容 */
+    bool DrainAll(std::string& batch, std::string& payload){
+        bool any = false;
+        std::lock_guard<std::mutex> lock(queuesMutex);
+        for (auto it = queues.begin(); it != queues.end();) {
+            Detail::ProducerQueue& queue = **it;
+            /* 先读 closed 再读数据, 避免漏掉线程退出前的最后几条 */
+            const bool closed = queue.closed.load(std::memory_order_acquire);
+            Detail::RecordHeader header;
+            while (queue.ring.PopN(reinterpret_cast<char*>(&header), sizeof(header)) == sizeof(header)) {
+                payload.resize(header.size);
+                queue.ring.PopN(payload.data(), header.size);
+                header.render(payload.data(), payload.size(), batch);
+                any = true;
+            }
+            /* 丢弃发生在队列满的时候, 放在已经入队的日志之后报告 */
+            const uint64_t dropped = queue.dropped.exchange(0, std::memory_order_relaxed);
+            if (dropped != 0 && options.reportDrops) {
+                batch += "[AsyncLogger] dropped ";
+                batch += std::to_string(dropped);
+                batch += " messages\n";
+                any = true;
+            }
+            if (closed) {
+                it = queues.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        return any;
+    }
+
+    /* sink 的异常不能逃出后台线程: 丢弃这一批并计数, 之后的日志继续尝试写入 */
+    void WriteToSink(const LogSlice* slices, size_t count) noexcept{
+        try {
+            sink.Write(slices, count);
+        } catch (...) {
+            failedWrites.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    void FlushSink() noexcept{
+        try {
+            sink.Flush();
+        } catch (...) {
+            failedWrites.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    void WriterLoop(){
+        std::string batch;
+        std::string payload;
+        for (;;) {
+            const uint64_t request = flushRequests.load(std::memory_order_acquire);
+            const bool stopping = stopped.load(std::memory_order_acquire);
+            const bool any = DrainAll(batch, payload);
+            if (!batch.empty()) {
+                const LogSlice slice{ batch.data(), batch.size() };
+                WriteToSink(&slice, 1);
+                batch.clear();
+            }
+            if (any || request != flushed.load(std::memory_order_relaxed)) {
+                FlushSink();
+            }
+            if (request != flushed.load(std::memory_order_relaxed)) {
+                flushed.store(request, std::memory_order_release);
+                flushed.notify_all();
+            }
+            /* stopping 是在读空之前看到的, 所以 Stop 之前入队的日志都已经写出 */
+            if (stopping) {
+                flushed.store(UINT64_MAX, std::memory_order_release);
+                flushed.notify_all();
+                return ;
+            }
+            if (!any) {
+                std::unique_lock<std::mutex> lock(wakeMutex);
+                wakeCv.wait_for(lock, options.flushInterval, [this]{ return wakeRequested; });
+                wakeRequested = false;
+            }
+        }
+    }
+
+private:
+    std::unique_ptr<ILogSink> ownedSink;
+    ILogSink& sink;
+    AsyncLoggerOptions options;
+    const uint64_t id;      /* 区分不同的 logger 实例, 不复用地址 */
+
+    std::mutex queuesMutex;
+    std::vector<std::shared_ptr<Detail::ProducerQueue>> queues;
+
+    std::mutex wakeMutex;
+    std::condition_variable wakeCv;
+    bool wakeRequested { false };
+
+    std::atomic<bool> stopped { false };
+    std::atomic<uint64_t> flushRequests { 0 };
+    std::atomic<uint64_t> flushed { 0 };
+    std::atomic<uint64_t> droppedTotal { 0 };
+    std::atomic<uint64_t> failedWrites { 0 };
+    std::thread writer;
+};
+
+}
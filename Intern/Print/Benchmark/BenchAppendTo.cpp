@@ -0,0 +1,93 @@
+#include <numeric>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <benchmark/benchmark.h>
+
+#include "../PrintTools.hpp"
+
+using namespace Tools;
+
+namespace {
+/* 改动前的 ValToString / RangeToString: 每个元素一次 std::to_string 或一个 std::ostringstream */
+namespace Legacy{
+template <typename ValTy>
+std::string ValToString(const ValTy& val){
+    return std::to_string(val);
+}
+
+template <typename Range>
+std::string RangeToString(const Range& range){
+    std::string res = "";
+    for (const auto& item : range) {
+        if constexpr (std::is_scalar<std::remove_cvref_t<decltype(item)>>::value) {
+            res += ValToString(item) + ", ";
+        } else {
+            std::ostringstream ss;
+            ss << item;
+            res += ss.str() + ", ";
+        }
+    }
+    res.pop_back();
+    res.pop_back();
+    return res;
+}
+}
+
+template <typename Ty>
+std::vector<Ty> MakeRange(size_t size){
+    std::vector<Ty> values(size);
+    for (size_t i = 0; i < size; ++i) {
+        if constexpr (std::is_same_v<Ty, std::string>) {
+            values[i] = "item" + std::to_string(i);
+        } else {
+            values[i] = static_cast<Ty>(i) * static_cast<Ty>(3) / static_cast<Ty>(2) + static_cast<Ty>(1);
+        }
+    }
+    return values;
+}
+
+template <typename Ty>
+void BM_LegacyRangeToString(benchmark::State& state){
+    const std::vector<Ty> values = MakeRange<Ty>(static_cast<size_t>(state.range(0)));
+    for (auto _ : state) {
+        std::string text = Legacy::RangeToString(values);
+        benchmark::DoNotOptimize(text);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+/* 新的 RangeToString: 仍然返回新的 std::string */
+template <typename Ty>
+void BM_RangeToString(benchmark::State& state){
+    const std::vector<Ty> values = MakeRange<Ty>(static_cast<size_t>(state.range(0)));
+    for (auto _ : state) {
+        std::string text = RangeToString(values);
+        benchmark::DoNotOptimize(text);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+/* AppendRange 写入复用的缓冲, 稳定后不再分配内存 */
+template <typename Ty>
+void BM_AppendRange(benchmark::State& state){
+    const std::vector<Ty> values = MakeRange<Ty>(static_cast<size_t>(state.range(0)));
+    std::string buffer;
+    for (auto _ : state) {
+        buffer.clear();
+        AppendRange(buffer, values);
+        benchmark::DoNotOptimize(buffer.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+}
+
+BENCHMARK(BM_LegacyRangeToString<int>)->Range(1 << 10, 1 << 16);
+BENCHMARK(BM_RangeToString<int>)->Range(1 << 10, 1 << 16);
+BENCHMARK(BM_AppendRange<int>)->Range(1 << 10, 1 << 16);
+BENCHMARK(BM_LegacyRangeToString<double>)->Range(1 << 10, 1 << 16);
+BENCHMARK(BM_RangeToString<double>)->Range(1 << 10, 1 << 16);
+BENCHMARK(BM_AppendRange<double>)->Range(1 << 10, 1 << 16);
+BENCHMARK(BM_LegacyRangeToString<std::string>)->Range(1 << 10, 1 << 16);
+BENCHMARK(BM_RangeToString<std::string>)->Range(1 << 10, 1 << 16);
+BENCHMARK(BM_AppendRange<std::string>)->Range(1 << 10, 1 << 16);
@@ -0,0 +1,51 @@
+#include <cstdint>
+#include <string>
+#include <benchmark/benchmark.h>
+
+#include "../BinaryLog.hpp"
+#include "../Print.hpp"
+
+using namespace Tools;
+
+namespace {
+/* 只统计字节数的 sink, 排除 I/O 的影响 */
+class CountingSink final : public ILogSink{
+public:
+    void Write(const LogSlice* slices, size_t count) override{
+        for (size_t i = 0; i < count; ++i) bytes += slices[i].size;
+    }
+    size_t bytes { 0 };
+};
+
+/* 同一条消息: 文本格式化 (调用线程) 与二进制编码的调用方耗时和每条的字节数 */
+void BM_TextLog(benchmark::State& state){
+    CountingSink sink;
+    {
+        AsyncLogger logger(sink);
+        const std::string name = "player_42";
+        int64_t frame = 0;
+        for (auto _ : state) {
+            Print(logger, Level::Normal, "frame ", ++frame, " entity ", name, " pos=", 12.5, ",", -3.25, " hp=", 97);
+        }
+        logger.Stop();
+    }
+    state.counters["bytes/record"] = static_cast<double>(sink.bytes) / static_cast<double>(state.iterations());
+}
+
+void BM_BinaryLog(benchmark::State& state){
+    CountingSink sink;
+    {
+        BinaryLog log(sink);
+        const std::string name = "player_42";
+        int64_t frame = 0;
+        for (auto _ : state) {
+            PRINT_BINARY(Level::Normal, log, "frame ", ++frame, " entity ", name, " pos=", 12.5, ",", -3.25, " hp=", 97);
+        }
+        log.Stop();
+    }
+    state.counters["bytes/record"] = static_cast<double>(sink.bytes) / static_cast<double>(state.iterations());
+}
+}
+
+BENCHMARK(BM_TextLog);
+BENCHMARK(BM_BinaryLog);
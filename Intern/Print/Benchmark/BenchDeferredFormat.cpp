@@ -0,0 +1,47 @@
+#include <fstream>
+#include <string>
+#include <benchmark/benchmark.h>
+
+#include "../Print.hpp"
+
+using namespace Tools;
+
+namespace {
+/* 写到 /dev/null, 只比较调用线程上的开销 */
+AsyncLogger& Logger(FormatMode mode){
+    static std::ofstream devNull("/dev/null");
+    auto make = [](FormatMode format){
+        AsyncLoggerOptions options;
+        options.queueBytes = 1 << 22;
+        options.format = format;
+        return options;
+    };
+    static AsyncLogger eager(devNull, make(FormatMode::Eager));
+    static AsyncLogger deferred(devNull, make(FormatMode::Deferred));
+    return mode == FormatMode::Eager ? eager : deferred;
+}
+
+void BM_PrintMixedArgs(benchmark::State& state){
+    AsyncLogger& logger = Logger(static_cast<FormatMode>(state.range(0)));
+    const std::string name = "render-thread";
+    uint64_t frame = 0;
+    for (auto _ : state) {
+        Print(logger, Level::Normal, "frame ", frame++, " on ", name, " took ", 16.6667, " ms, visible ", 1234, '/', 5678);
+    }
+    logger.Flush();
+    state.SetItemsProcessed(state.iterations());
+}
+
+void BM_PrintFormat(benchmark::State& state){
+    AsyncLogger& logger = Logger(FormatMode::Deferred);
+    uint64_t frame = 0;
+    for (auto _ : state) {
+        PrintFormat(logger, Level::Normal, "frame {} took {} ms, visible {}/{}", frame++, 16.6667, 1234, 5678);
+    }
+    logger.Flush();
+    state.SetItemsProcessed(state.iterations());
+}
+}
+
+BENCHMARK(BM_PrintMixedArgs)->ArgName("deferred")->Arg(static_cast<int>(FormatMode::Eager))->Arg(static_cast<int>(FormatMode::Deferred));
+BENCHMARK(BM_PrintFormat);
@@ -0,0 +1,74 @@
+#include <filesystem>
+#include <string>
+#include <vector>
+#include <benchmark/benchmark.h>
+
+#include "../MappedFileSink.hpp"
+
+#if defined(TOOLS_HAS_POSIX_SINK)
+using namespace Tools;
+
+namespace {
+/* 一次 Write 的批次: range(0) 行, 每行 range(1) 字节, 与 AsyncLogger / BufferedLogger 一次写出的规模相当 */
+std::vector<std::string> MakeLines(benchmark::State& state){
+    std::vector<std::string> lines(static_cast<size_t>(state.range(0)));
+    for (size_t i = 0; i < lines.size(); ++i) {
+        lines[i].assign(static_cast<size_t>(state.range(1)) - 1, static_cast<char>('a' + i % 26));
+        lines[i].push_back('\n');
+    }
+    return lines;
+}
+
+std::string BenchPath(const char* name){
+    return (std::filesystem::temp_directory_path() / name).string();
+}
+
+template <typename Sink>
+void RunSustained(benchmark::State& state, Sink& sink){
+    const std::vector<std::string> lines = MakeLines(state);
+    std::vector<LogSlice> slices;
+    size_t batchBytes = 0;
+    for (const std::string& line : lines) {
+        slices.push_back(LogSlice{ line.data(), line.size() });
+        batchBytes += line.size();
+    }
+    for (auto _ : state) {
+        sink.Write(slices.data(), slices.size());
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * batchBytes));
+}
+
+/* 对照: O_APPEND 文件 + writev */
+void BM_FileSink(benchmark::State& state){
+    const std::string path = BenchPath("bench_file_sink.log");
+    std::filesystem::remove(path);
+    {
+        FileSink sink(path);
+        RunSustained(state, sink);
+    }
+    std::filesystem::remove(path);
+}
+
+/* 64MB 的映射段, 最多保留 4 个, 包含切换段的开销 */
+void BM_MappedFileSink(benchmark::State& state){
+    const std::string path = BenchPath("bench_mapped_sink.log");
+    size_t stalls = 0;
+    {
+        MappedFileSink sink(path, { .segmentBytes = 64 * 1024 * 1024, .maxSegments = 4 });
+        RunSustained(state, sink);
+        stalls = sink.GetStallCount();
+    }
+    state.counters["stalls"] = static_cast<double>(stalls);
+    /* 旧的段已经被 maxSegments 删掉, 按前缀清理剩下的 */
+    const std::string prefix = std::filesystem::path(path).filename().string() + ".";
+    for (const auto& entry : std::filesystem::directory_iterator(std::filesystem::temp_directory_path())) {
+        if (entry.path().filename().string().starts_with(prefix)) {
+            std::filesystem::remove(entry.path());
+        }
+    }
+}
+}
+
+BENCHMARK(BM_FileSink)->Args({ 64, 128 })->Args({ 1, 128 })->Args({ 16, 1024 })->UseRealTime();
+BENCHMARK(BM_MappedFileSink)->Args({ 64, 128 })->Args({ 1, 128 })->Args({ 16, 1024 })->UseRealTime();
+#endif
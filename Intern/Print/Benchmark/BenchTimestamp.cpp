@@ -0,0 +1,56 @@
+#include <chrono>
+#include <string>
+#include <benchmark/benchmark.h>
+
+#include "../Printable.hpp"
+
+using namespace Tools;
+
+namespace {
+/* 改动前: 每条日志一次 GetTimeToString */
+void BM_GetTimeToString(benchmark::State& state){
+    for (auto _ : state) {
+        std::string stamp = GetTimeToString("{}-{}-{},{}-{}-{}", std::chrono::system_clock::now());
+        benchmark::DoNotOptimize(stamp);
+    }
+}
+
+/* 每线程按秒缓存前缀, 时间来源为 system_clock */
+void BM_FormatTimestamp_SystemClock(benchmark::State& state){
+    char buffer[kTimestampMaxLength];
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(FormatTimestamp(buffer, std::chrono::system_clock::now()));
+        benchmark::ClobberMemory();
+    }
+}
+
+/* 每线程按秒缓存前缀, 时间来源为 WallClock (x86 上是 TSC) */
+void BM_FormatTimestamp_WallClock(benchmark::State& state){
+    char buffer[kTimestampMaxLength];
+    WallClock::Calibrate();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(FormatTimestamp(buffer, WallClock::Now()));
+        benchmark::ClobberMemory();
+    }
+    state.counters["tsc"] = WallClock::UsesTsc();
+}
+
+void BM_Now_SystemClock(benchmark::State& state){
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(std::chrono::system_clock::now());
+    }
+}
+
+void BM_Now_WallClock(benchmark::State& state){
+    WallClock::Calibrate();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(WallClock::Now());
+    }
+}
+}
+
+BENCHMARK(BM_GetTimeToString);
+BENCHMARK(BM_FormatTimestamp_SystemClock);
+BENCHMARK(BM_FormatTimestamp_WallClock);
+BENCHMARK(BM_Now_SystemClock);
+BENCHMARK(BM_Now_WallClock);
@@ -0,0 +1,372 @@
+/*
+ * PrintLatency: Tools::Print 的调用方延迟分布与持续吞吐
+ *
+ * 用法: PrintLatency [--threads N] [--messages M] [--mode 模式]... [--sink sink]... [--dir 目录] [--out 文件]
+ *   --threads N     线程数依次取 1, 2, 4, ... 直到 N (默认 min(硬件线程数, 8))
+ *   --messages M    每个线程测量的条数 (默认 100000), 之前另有 M / 10 条预热
+ *   --mode          sync / buffered / async / deferred, 可以重复, 默认全部
+ *   --sink          devnull / file / mapped, 可以重复, 默认全部
+ *   --dir           file / mapped 的临时文件目录 (默认系统临时目录)
+ *   --out           JSON 输出文件 (默认 stdout)
+ *
+ * 模式:
+ *   sync      Print(std::ostream&): 调用线程格式化, 每行一次 sink 写入 (多线程时加锁)
+ *   buffered  Print(BufferedLogger&): 格式化后追加到线程缓冲
+ *   async     Print(AsyncLogger&): 格式化后入队, 后台线程写入
+ *   deferred  AsyncLogger + FormatMode::Deferred: 只拷贝参数字节, 格式化在后台线程
+ *
+ * 每条调用用 steady_clock 计时 (clock_overhead_ns 为两次读时钟本身的开销, 没有扣除);
+ * 吞吐按所有线程开始到 logger 停止 (全部写入 sink) 的时间计算. devnull 的结果排除了 I/O, 只剩格式化与排队的开销.
+ * 输出的 JSON 每个结果一行, 便于对比不同的构建.
+ */
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <latch>
+#include <memory>
+#include <mutex>
+#include <streambuf>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include "../../MappedFileSink.hpp"
+#include "../../Print.hpp"
+
+#if defined(TOOLS_HAS_POSIX_SINK)
+#include <fcntl.h>
+
+using namespace Tools;
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+/* 统计写入的字节数, 再转交给实际的 sink */
+class CountingSink final : public ILogSink{
+public:
+    explicit CountingSink(std::unique_ptr<ILogSink> inner)
+        : inner(std::move(inner)) {}
+
+    void Write(const LogSlice* slices, size_t count) override{
+        for (size_t i = 0; i < count; ++i) bytes += slices[i].size;
+        inner->Write(slices, count);
+    }
+    void Flush() override{
+        inner->Flush();
+    }
+    size_t GetBytes() const noexcept{
+        return bytes;
+    }
+
+private:
+    std::unique_ptr<ILogSink> inner;
+    size_t bytes { 0 };
+};
+
+/* 没有缓冲的 streambuf, 每次 write 直接写入 sink; 加锁后可以被多个线程各自的 ostream 共享 */
+class SinkStreambuf final : public std::streambuf{
+public:
+    explicit SinkStreambuf(ILogSink& sink)
+        : sink(sink) {}
+
+protected:
+    std::streamsize xsputn(const char* data, std::streamsize count) override{
+        const LogSlice slice{ data, static_cast<size_t>(count) };
+        std::lock_guard<std::mutex> lock(mutex);
+        sink.Write(&slice, 1);
+        return count;
+    }
+    int_type overflow(int_type ch) override{
+        if (traits_type::eq_int_type(ch, traits_type::eof())) return traits_type::not_eof(ch);
+        const char value = traits_type::to_char_type(ch);
+        xsputn(&value, 1);
+        return ch;
+    }
+
+private:
+    ILogSink& sink;
+    std::mutex mutex;
+};
+
+struct Config{
+    std::string_view mode;
+    std::string_view sink;
+    std::string_view message;
+    size_t threads { 1 };
+    size_t messages { 0 };
+};
+
+struct Result{
+    Config config;
+    size_t bytes { 0 };
+    uint64_t dropped { 0 };
+    double seconds { 0.0 };
+    int64_t p50 { 0 };
+    int64_t p99 { 0 };
+    int64_t p999 { 0 };
+    int64_t max { 0 };
+    double mean { 0.0 };
+};
+
+const std::string kName(24, 'n');
+const std::string kPayload(96, 'p');
+
+/* short 约 20 字节, long 约 200 字节, 混合整数 / 浮点 / 字符串 */
+template <typename Target>
+void LogOne(Target& target, std::string_view message, uint64_t i){
+    if (message == "short") {
+        Print(target, Level::Normal, "frame ", i, " done");
+    } else {
+        Print(target, Level::Normal, "entity ", kName, " pos=", 1.5 * static_cast<double>(i), ",", -0.25, ",", 1e-3,
+              " hp=", static_cast<int>(i % 100), " alive=", true, " payload=", kPayload, " tick=", i);
+    }
+}
+
+std::unique_ptr<ILogSink> MakeSink(std::string_view name, const std::filesystem::path& dir){
+    if (name == "devnull") {
+        const int fd = ::open("/dev/null", O_WRONLY | O_CLOEXEC);
+        if (fd < 0) throw std::system_error(errno, std::generic_category(), "open /dev/null");
+        return std::make_unique<FdSink>(fd, true);
+    }
+    if (name == "file") {
+        return std::make_unique<FileSink>((dir / "print_latency.log").string());
+    }
+    return std::make_unique<MappedFileSink>((dir / "print_latency.mapped").string(),
+                                            MappedFileSinkOptions{ .segmentBytes = 64 * 1024 * 1024, .maxSegments = 2 });
+}
+
+void RemoveFiles(const std::filesystem::path& dir){
+    for (const auto& entry : std::filesystem::directory_iterator(dir)) {
+        if (entry.path().filename().string().starts_with("print_latency.")) {
+            std::filesystem::remove(entry.path());
+        }
+    }
+}
+
+/* 每个线程: 等待同时开始, 预热后逐条计时 */
+template <typename MakeTarget>
+std::vector<int64_t> RunThreads(const Config& config, MakeTarget&& makeTarget, Clock::time_point& start){
+    std::vector<std::vector<int64_t>> samples(config.threads);
+    std::latch ready(static_cast<std::ptrdiff_t>(config.threads));
+    std::latch go(1);
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < config.threads; ++t) {
+        threads.emplace_back([&, t]{
+            auto target = makeTarget();
+            std::vector<int64_t>& mine = samples[t];
+            mine.resize(config.messages);
+            const size_t warmup = config.messages / 10;
+            ready.count_down();
+            go.wait();
+            for (size_t i = 0; i < warmup; ++i) LogOne(*target, config.message, i);
+            for (size_t i = 0; i < config.messages; ++i) {
+                const Clock::time_point begin = Clock::now();
+                LogOne(*target, config.message, i);
+                mine[i] = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - begin).count();
+            }
+        });
+    }
+    ready.wait();
+    start = Clock::now();
+    go.count_down();
+    for (auto& thread : threads) thread.join();
+
+    std::vector<int64_t> merged;
+    merged.reserve(config.threads * config.messages);
+    for (const auto& mine : samples) merged.insert(merged.end(), mine.begin(), mine.end());
+    return merged;
+}
+
+/* 返回指向共享 logger 的 "target", 让 RunThreads 对所有模式一视同仁 */
+template <typename Logger>
+auto Shared(Logger& logger){
+    return [&logger]{ return &logger; };
+}
+
+Result Run(const Config& config, const std::filesystem::path& dir){
+    Result result{ config };
+    CountingSink sink(MakeSink(config.sink, dir));
+    Clock::time_point start;
+    std::vector<int64_t> samples;
+    if (config.mode == "sync") {
+        SinkStreambuf buf(sink);
+        samples = RunThreads(config, [&]{ return std::make_unique<std::ostream>(&buf); }, start);
+    } else if (config.mode == "buffered") {
+        BufferedLogger logger(sink);
+        samples = RunThreads(config, Shared(logger), start);
+        logger.Stop();
+    } else {
+        AsyncLogger logger(sink, { .queueBytes = 1 << 20,
+                                   .format = config.mode == "deferred" ? FormatMode::Deferred : FormatMode::Eager });
+        samples = RunThreads(config, Shared(logger), start);
+        logger.Stop();
+        result.dropped = logger.GetDroppedCount();
+    }
+    result.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    result.bytes = sink.GetBytes();
+
+    std::sort(samples.begin(), samples.end());
+    auto at = [&](double q){
+        const size_t index = static_cast<size_t>(q * static_cast<double>(samples.size()));
+        return samples[std::min(index, samples.size() - 1)];
+    };
+    result.p50 = at(0.50);
+    result.p99 = at(0.99);
+    result.p999 = at(0.999);
+    result.max = samples.back();
+    double sum = 0.0;
+    for (const int64_t sample : samples) sum += static_cast<double>(sample);
+    result.mean = sum / static_cast<double>(samples.size());
+    return result;
+}
+
+int64_t ClockOverhead(){
+    constexpr int kRounds = 100000;
+    const Clock::time_point begin = Clock::now();
+    for (int i = 0; i < kRounds; ++i) {
+        const Clock::time_point a = Clock::now();
+        const Clock::time_point b = Clock::now();
+        if (b < a) std::abort();
+    }
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - begin).count() / kRounds;
+}
+
+void AppendResult(std::string& out, const Result& result){
+    const double total = static_cast<double>(result.config.threads * result.config.messages
+                                             + result.config.threads * (result.config.messages / 10));
+    out += "    {\"mode\":\"";
+    out += result.config.mode;
+    out += "\",\"sink\":\"";
+    out += result.config.sink;
+    out += "\",\"message\":\"";
+    out += result.config.message;
+    out += "\",\"threads\":";
+    AppendTo(out, result.config.threads);
+    out += ",\"messages\":";
+    AppendTo(out, result.config.threads * result.config.messages);
+    out += ",\"p50_ns\":";
+    AppendTo(out, result.p50);
+    out += ",\"p99_ns\":";
+    AppendTo(out, result.p99);
+    out += ",\"p999_ns\":";
+    AppendTo(out, result.p999);
+    out += ",\"max_ns\":";
+    AppendTo(out, result.max);
+    out += ",\"mean_ns\":";
+    AppendTo(out, static_cast<int64_t>(result.mean));
+    out += ",\"msgs_per_sec\":";
+    AppendTo(out, static_cast<int64_t>(total / result.seconds));
+    out += ",\"mb_per_sec\":";
+    AppendTo(out, static_cast<int64_t>(static_cast<double>(result.bytes) / result.seconds / 1e6 * 10.0) / 10.0);
+    out += ",\"bytes\":";
+    AppendTo(out, result.bytes);
+    out += ",\"dropped\":";
+    AppendTo(out, result.dropped);
+    out += "}";
+}
+
+/* 1, 2, 4, ..., maxThreads */
+std::vector<size_t> ThreadCounts(size_t maxThreads){
+    std::vector<size_t> counts;
+    for (size_t threads = 1; threads < maxThreads; threads *= 2) counts.push_back(threads);
+    counts.push_back(maxThreads);
+    return counts;
+}
+
+struct Options{
+    size_t maxThreads { std::clamp<size_t>(std::thread::hardware_concurrency(), 1, 8) };
+    size_t messages { 100000 };
+    std::vector<std::string_view> modes;
+    std::vector<std::string_view> sinks;
+    std::filesystem::path dir { std::filesystem::temp_directory_path() };
+    std::string out;
+};
+
+bool ParseOptions(int argc, char** argv, Options& options){
+    constexpr std::string_view kModes[] = { "sync", "buffered", "async", "deferred" };
+    constexpr std::string_view kSinks[] = { "devnull", "file", "mapped" };
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view arg = argv[i];
+        if (i + 1 >= argc) return false;
+        const std::string_view value = argv[++i];
+        if (arg == "--threads") {
+            options.maxThreads = std::max<size_t>(1, std::strtoull(value.data(), nullptr, 10));
+        } else if (arg == "--messages") {
+            options.messages = std::max<size_t>(1, std::strtoull(value.data(), nullptr, 10));
+        } else if (arg == "--mode" && std::find(std::begin(kModes), std::end(kModes), value) != std::end(kModes)) {
+            options.modes.push_back(value);
+        } else if (arg == "--sink" && std::find(std::begin(kSinks), std::end(kSinks), value) != std::end(kSinks)) {
+            options.sinks.push_back(value);
+        } else if (arg == "--dir") {
+            options.dir = value;
+        } else if (arg == "--out") {
+            options.out = value;
+        } else {
+            return false;
+        }
+    }
+    if (options.modes.empty()) options.modes.assign(std::begin(kModes), std::end(kModes));
+    if (options.sinks.empty()) options.sinks.assign(std::begin(kSinks), std::end(kSinks));
+    return true;
+}
+}
+
+int main(int argc, char** argv){
+    Options options;
+    if (!ParseOptions(argc, argv, options)) {
+        std::cerr << "usage: " << argv[0] << " [--threads N] [--messages M] [--mode sync|buffered|async|deferred]..."
+                  << " [--sink devnull|file|mapped]... [--dir DIR] [--out FILE]\n";
+        return 2;
+    }
+
+    std::string json = "{\n  \"suite\":\"PrintLatency\",\"hardware_threads\":";
+    AppendTo(json, std::thread::hardware_concurrency());
+    json += ",\"clock_overhead_ns\":";
+    AppendTo(json, ClockOverhead());
+    json += ",\"tsc_wall_clock\":";
+    AppendTo(json, WallClock::UsesTsc());
+    json += ",\n  \"results\":[\n";
+
+    bool first = true;
+    for (const std::string_view sink : options.sinks) {
+        for (const std::string_view mode : options.modes) {
+            for (const std::string_view message : { std::string_view("short"), std::string_view("long") }) {
+                for (const size_t threads : ThreadCounts(options.maxThreads)) {
+                    const Config config{ mode, sink, message, threads, options.messages };
+                    std::cerr << mode << " / " << sink << " / " << message << " / " << threads << " threads\n";
+                    const Result result = Run(config, options.dir);
+                    RemoveFiles(options.dir);
+                    if (!first) json += ",\n";
+                    first = false;
+                    AppendResult(json, result);
+                }
+            }
+        }
+    }
+    json += "\n  ]\n}\n";
+
+    if (options.out.empty()) {
+        std::fwrite(json.data(), 1, json.size(), stdout);
+    } else {
+        std::FILE* file = std::fopen(options.out.c_str(), "w");
+        if (file == nullptr) {
+            std::cerr << "cannot open " << options.out << "\n";
+            return 1;
+        }
+        std::fwrite(json.data(), 1, json.size(), file);
+        std::fclose(file);
+    }
+    return 0;
+}
+#else
+int main(){
+    std::cerr << "PrintLatency needs the POSIX sinks (Linux / macOS)\n";
+    return 1;
+}
+#endif
@@ -0,0 +1,490 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <source_location>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "AsyncLogger.hpp"
+#include "DeferredFormat.hpp"
+#include "LogLevel.hpp"
+#include "LogSink.hpp"
+#include "SmallBuffer.hpp"
+#include "Timestamp.hpp"
+
+/*
+ * 二进制日志格式 (本机字节序, 解码需要在同字节序的机器上进行)
+ *
+ *   文件头: BinaryFileHeader (16 字节), 只出现在文件开头; 多个文件或 MappedFileSink 的段可以直接拼接后解码
+ *   MappedFileSink 在任意字节处切换段, 记录会跨段, 所以段必须按序号拼接成一个流再解码 (见 GroupBinaryLogStreams)
+ *   记录:   BinaryRecordHeader (24 字节) + payload, size 是整条记录的字节数, 过滤时只读记录头, 按 size 跳过
+ *     - Log 记录: payload 是 fieldCount 个字段, 每个字段为 [uint8 类型 | 值]
+ *     - Callsite 记录: 调用点的定义 [uint32 行号 | 字符串 文件 | 字符串 函数], 第一次使用某个调用点时写入
+ *       不同线程之间不保证顺序, 所以定义可能出现在使用它的记录之后, 解码器先扫描一遍所有的定义
+ *   字符串: [uint32 长度 | 内容]
+ */
+namespace Tools{
+inline constexpr char kBinaryLogMagic[8] = { 'T', 'O', 'O', 'L', 'S', 'L', 'O', 'G' };
+inline constexpr uint32_t kBinaryLogVersion = 1;
+
+struct BinaryFileHeader{
+    char magic[8];
+    uint32_t version;
+    uint32_t recordHeaderSize;
+};
+
+enum class BinaryRecordKind : uint8_t{
+    Log = 0, Callsite = 1
+};
+
+struct BinaryRecordHeader{
+    uint32_t size;              /* 整条记录的字节数, 包括记录头 */
+    BinaryRecordKind kind;
+    uint8_t level;
+    uint16_t fieldCount;
+    uint32_t threadId;          /* 进程内的线程序号, 从 1 开始 */
+    uint32_t callsiteId;
+    int64_t timestamp;          /* system_clock 纳秒 */
+};
+static_assert(sizeof(BinaryRecordHeader) == 24);
+
+enum class BinaryFieldType : uint8_t{
+    Bool = 1, Char, I32, U32, I64, U64, F32, F64, String
+};
+
+/*
+ * @function: 一个调用点, 由 PRINT_BINARY 宏在调用处定义为 static
+ * @note: id 在进程内从 1 开始连续分配
+ */
+struct BinaryCallsite{
+    explicit BinaryCallsite(std::source_location location = std::source_location::current()) noexcept
+        : location(location), id(NextId()) {}
+
+    std::source_location location;
+    uint32_t id;
+
+private:
+    static uint32_t NextId() noexcept{
+        static std::atomic<uint32_t> counter { 0 };
+        return counter.fetch_add(1, std::memory_order_relaxed) + 1;
+    }
+};
+
+namespace Detail{
+/* 进程内的线程序号, 比 std::thread::id 紧凑 */
+inline uint32_t LocalThreadIndex() noexcept{
+    static std::atomic<uint32_t> counter { 0 };
+    thread_local const uint32_t index = counter.fetch_add(1, std::memory_order_relaxed) + 1;
+    return index;
+}
+
+template <typename Ty>
+void AppendRaw(std::string& out, const Ty& value){
+    out.append(reinterpret_cast<const char*>(&value), sizeof(Ty));
+}
+
+inline void AppendBinaryString(std::string& out, std::string_view value){
+    out.push_back(static_cast<char>(BinaryFieldType::String));
+    AppendRaw(out, static_cast<uint32_t>(value.size()));
+    out.append(value.data(), value.size());
+}
+
+/*
+ * 一个参数编码为一个字段
+ * 算术类型与 enum 按值写入; 字符串写入内容; 其余类型在调用线程上用 AppendArg 转换为文本后作为字符串写入
+ */
+template <typename Ty>
+void EncodeBinaryField(std::string& out, const Ty& value){
+    using Target = std::remove_cvref_t<Ty>;
+    if constexpr (std::is_same_v<Target, bool>) {
+        out.push_back(static_cast<char>(BinaryFieldType::Bool));
+        out.push_back(value ? 1 : 0);
+    } else if constexpr (kIsCharLike<Target>) {
+        out.push_back(static_cast<char>(BinaryFieldType::Char));
+        out.push_back(static_cast<char>(value));
+    } else if constexpr (std::is_enum_v<Target>) {
+        EncodeBinaryField(out, static_cast<std::underlying_type_t<Target>>(value));
+    } else if constexpr (std::is_integral_v<Target> && !kIsWideChar<Target>) {
+        if constexpr (sizeof(Target) <= 4) {
+            out.push_back(static_cast<char>(std::is_signed_v<Target> ? BinaryFieldType::I32 : BinaryFieldType::U32));
+            if constexpr (std::is_signed_v<Target>) AppendRaw(out, static_cast<int32_t>(value));
+            else AppendRaw(out, static_cast<uint32_t>(value));
+        } else {
+            out.push_back(static_cast<char>(std::is_signed_v<Target> ? BinaryFieldType::I64 : BinaryFieldType::U64));
+            if constexpr (std::is_signed_v<Target>) AppendRaw(out, static_cast<int64_t>(value));
+            else AppendRaw(out, static_cast<uint64_t>(value));
+        }
+    } else if constexpr (std::is_same_v<Target, float>) {
+        out.push_back(static_cast<char>(BinaryFieldType::F32));
+        AppendRaw(out, value);
+    } else if constexpr (std::is_floating_point_v<Target>) {
+        out.push_back(static_cast<char>(BinaryFieldType::F64));
+        AppendRaw(out, static_cast<double>(value));
+    } else if constexpr (std::is_same_v<Target, std::string> || std::is_same_v<Target, std::string_view>) {
+        AppendBinaryString(out, value);
+    } else if constexpr (std::is_same_v<Target, const char*> || std::is_same_v<Target, char*>) {
+        AppendBinaryString(out, value ? std::string_view(value) : std::string_view("nullptr"));
+    } else if constexpr (std::is_array_v<Target> && std::is_same_v<std::remove_cv_t<std::remove_extent_t<Target>>, char>) {
+        AppendBinaryString(out, std::string_view(value, std::char_traits<char>::length(value)));
+    } else {
+        SmallBuffer<> text;
+        AppendArg(text, value);
+        AppendBinaryString(out, text.View());
+    }
+}
+
+inline void AppendRecordHeader(std::string& out, BinaryRecordKind kind, Level level, uint16_t fieldCount, uint32_t callsiteId){
+    BinaryRecordHeader header{};
+    header.kind = kind;
+    header.level = static_cast<uint8_t>(level);
+    header.fieldCount = fieldCount;
+    header.threadId = LocalThreadIndex();
+    header.callsiteId = callsiteId;
+    header.timestamp = WallClock::Now().time_since_epoch().count();
+    AppendRaw(out, header);
+}
+
+/* 记录写完后回填 size */
+inline void PatchRecordSize(std::string& out, size_t begin){
+    const uint32_t size = static_cast<uint32_t>(out.size() - begin);
+    std::memcpy(out.data() + begin, &size, sizeof(size));
+}
+
+inline void EncodeCallsite(std::string& out, const BinaryCallsite& site){
+    const size_t begin = out.size();
+    AppendRecordHeader(out, BinaryRecordKind::Callsite, Level::Debug, 0, site.id);
+    AppendRaw(out, static_cast<uint32_t>(site.location.line()));
+    const std::string_view file = site.location.file_name();
+    const std::string_view function = site.location.function_name();
+    AppendRaw(out, static_cast<uint32_t>(file.size()));
+    out.append(file);
+    AppendRaw(out, static_cast<uint32_t>(function.size()));
+    out.append(function);
+    PatchRecordSize(out, begin);
+}
+
+template <typename... Args>
+void EncodeBinaryRecord(std::string& out, Level level, uint32_t callsiteId, const Args&... args){
+    static_assert(sizeof...(Args) <= UINT16_MAX, "too many fields");
+    const size_t begin = out.size();
+    AppendRecordHeader(out, BinaryRecordKind::Log, level, static_cast<uint16_t>(sizeof...(Args)), callsiteId);
+    (EncodeBinaryField(out, args), ...);
+    PatchRecordSize(out, begin);
+}
+}
+
+struct BinaryLogOptions{
+    AsyncLoggerOptions async {};
+    size_t maxCallsites { 4096 };   /* 记录 "已写入定义" 的调用点个数, 超出的调用点每条记录都会附带定义 */
+};
+
+/*
+ * @function: 二进制日志前端, 调用线程只拷贝参数的原始字节, 写入复用 AsyncLogger 的线程队列与后台线程
+ * @note: 构造时先向 sink 写入文件头, 之后的记录由 AsyncLogger 批量写出
+ * @note: 文本由单独的解码工具 PrintLogDecoder 生成, 见 doc.md
+ * @Usage:
+    Tools::FileSink file("game.blog");
+    Tools::BinaryLog log(file);
+    PRINT_BINARY(Tools::Level::Normal, log, "frame ", frameIndex, " took ", ms, " ms");
+ */
+class BinaryLog{
+public:
+    explicit BinaryLog(ILogSink& sink, BinaryLogOptions options = {})
+        : headerWritten(WriteFileHeader(sink)),
+          defined(std::make_unique<std::atomic<bool>[]>(options.maxCallsites)),
+          maxCallsites(options.maxCallsites),
+          logger(sink, Normalize(options.async)) {}
+
+    BinaryLog(const BinaryLog&) = delete;
+    BinaryLog& operator=(const BinaryLog&) = delete;
+
+    template <typename... Args>
+    bool Log(Level level, const BinaryCallsite& site, const Args&... args){
+        const bool needDefinition = site.id >= maxCallsites ||
+            (!defined[site.id].load(std::memory_order_relaxed) && !defined[site.id].exchange(true, std::memory_order_relaxed));
+        const bool emitted = logger.Emit(level, &Detail::RenderText, [&](Detail::LineWriter& writer){
+            if (needDefinition) Detail::EncodeCallsite(writer.record, site);
+            Detail::EncodeBinaryRecord(writer.record, level, site.id, args...);
+        });
+        /* 带定义的记录被丢弃 (队列满) 时撤销标记, 让下一次调用重新携带定义 */
+        if (!emitted && needDefinition && site.id < maxCallsites) {
+            defined[site.id].store(false, std::memory_order_relaxed);
+        }
+        return emitted;
+    }
+
+    void Flush(){
+        logger.Flush();
+    }
+    void Stop(){
+        logger.Stop();
+    }
+    uint64_t GetDroppedCount() const noexcept{
+        return logger.GetDroppedCount();
+    }
+    uint64_t GetFailedWriteCount() const noexcept{
+        return logger.GetFailedWriteCount();
+    }
+
+private:
+    static bool WriteFileHeader(ILogSink& sink){
+        BinaryFileHeader header{};
+        std::memcpy(header.magic, kBinaryLogMagic, sizeof(header.magic));
+        header.version = kBinaryLogVersion;
+        header.recordHeaderSize = sizeof(BinaryRecordHeader);
+        const LogSlice slice{ reinterpret_cast<const char*>(&header), sizeof(header) };
+        sink.Write(&slice, 1);
+        return true;
+    }
+
+    /* 记录已经是二进制, 不使用 Deferred; 丢弃数量的文本提示会破坏格式, 只计数 (GetDroppedCount) */
+    static AsyncLoggerOptions Normalize(AsyncLoggerOptions options) noexcept{
+        options.format = FormatMode::Eager;
+        options.reportDrops = false;
+        return options;
+    }
+
+private:
+    bool headerWritten;
+    std::unique_ptr<std::atomic<bool>[]> defined;
+    size_t maxCallsites;
+    AsyncLogger logger;
+};
+
+template <typename... Args>
+bool PrintBinary(BinaryLog& log, Level level, const BinaryCallsite& site, const Args&... args){
+    if (!IsLevelEnabled(level)) return false;
+    return log.Log(level, site, args...);
+}
+
+/* 一条记录的视图, payload 指向记录头之后的字节 */
+struct BinaryRecordView{
+    BinaryRecordHeader header;
+    const char* payload;
+    size_t payloadSize;
+};
+
+/*
+ * @function: 顺序读取二进制日志, 只解析记录头, 不解码字段
+ * @note: 开头的文件头 (如果有) 会被跳过; 遇到截断或损坏的记录 (例如 MappedFileSink 段末尾的 '\0' 填充) 时停止
+ */
+class BinaryLogReader{
+public:
+    explicit BinaryLogReader(std::string_view bytes) noexcept
+        : bytes(bytes){
+        SkipFileHeader();
+    }
+
+    bool Next(BinaryRecordView& record) noexcept{
+        for (;;) {
+            if (bytes.size() - offset < sizeof(BinaryRecordHeader)) return false;
+            /* 拼接的文件中间可能出现其他文件的文件头 */
+            if (std::memcmp(bytes.data() + offset, kBinaryLogMagic, sizeof(kBinaryLogMagic)) == 0) {
+                SkipFileHeader();
+                continue;
+            }
+            std::memcpy(&record.header, bytes.data() + offset, sizeof(BinaryRecordHeader));
+            if (record.header.size < sizeof(BinaryRecordHeader) || record.header.size > bytes.size() - offset) {
+                return false;
+            }
+            record.payload = bytes.data() + offset + sizeof(BinaryRecordHeader);
+            record.payloadSize = record.header.size - sizeof(BinaryRecordHeader);
+            offset += record.header.size;
+            return true;
+        }
+    }
+
+    /* 已经读过的字节数, 小于总长度说明末尾有无法解析的数据 */
+    size_t GetOffset() const noexcept{
+        return offset;
+    }
+
+private:
+    void SkipFileHeader() noexcept{
+        if (bytes.size() - offset >= sizeof(BinaryFileHeader) &&
+            std::memcmp(bytes.data() + offset, kBinaryLogMagic, sizeof(kBinaryLogMagic)) == 0) {
+            offset += sizeof(BinaryFileHeader);
+        }
+    }
+
+private:
+    std::string_view bytes;
+    size_t offset { 0 };
+};
+
+/*
+ * @function: 把要解码的文件分成若干字节流, 每个流按顺序拼接后交给一个 BinaryLogReader
+ * @note: 同一 basePath 的 MappedFileSink 段 ("<basePath>.<序号>") 按序号排序, 序号连续的段归为一个流 (记录可能跨段);
+ * @      序号不连续处 (例如 maxSegments 删除了中间的段) 和其他文件各自开始一个新流
+ * @note: 流按其第一个文件在 paths 中出现的位置排列
+ */
+inline std::vector<std::vector<std::string>> GroupBinaryLogStreams(const std::vector<std::string>& paths){
+    struct Segments{
+        std::string base;
+        std::vector<std::pair<uint64_t, std::string>> files;
+    };
+    /* 每个元素要么是一个 basePath 的全部段, 要么是单个普通文件 (base 为空, files 只有一个) */
+    std::vector<Segments> groups;
+    for (const std::string& path : paths) {
+        const size_t dot = path.find_last_of('.');
+        uint64_t index = 0;
+        bool isSegment = false;
+        if (dot != std::string::npos && dot > 0 && dot + 1 < path.size()) {
+            const char* end = path.data() + path.size();
+            const auto result = std::from_chars(path.data() + dot + 1, end, index);
+            isSegment = result.ec == std::errc() && result.ptr == end;
+        }
+        if (!isSegment) {
+            groups.push_back(Segments{ {}, { { 0, path } } });
+            continue;
+        }
+        const std::string_view base(path.data(), dot);
+        auto group = std::find_if(groups.begin(), groups.end(), [&](const Segments& g){ return !g.base.empty() && g.base == base; });
+        if (group == groups.end()) {
+            groups.push_back(Segments{ std::string(base), {} });
+            group = groups.end() - 1;
+        }
+        group->files.emplace_back(index, path);
+    }
+
+    std::vector<std::vector<std::string>> streams;
+    for (Segments& group : groups) {
+        std::sort(group.files.begin(), group.files.end());
+        for (size_t i = 0; i < group.files.size(); ++i) {
+            if (i == 0 || group.files[i].first != group.files[i - 1].first + 1) streams.emplace_back();
+            streams.back().push_back(std::move(group.files[i].second));
+        }
+    }
+    return streams;
+}
+
+/* 解码后的字段值 */
+struct BinaryField{
+    BinaryFieldType type {};
+    union{
+        bool boolean;
+        char character;
+        int64_t integer;
+        uint64_t unsignedInteger;
+        double floating;
+    };
+    std::string_view text;
+};
+
+/*
+ * @function: 依次解码一条 Log 记录的字段, 对每个字段调用 visit(const BinaryField&)
+ * @return: payload 完整时返回 true
+ */
+template <typename Visit>
+bool DecodeBinaryFields(const BinaryRecordView& record, Visit&& visit){
+    const char* cursor = record.payload;
+    const char* end = record.payload + record.payloadSize;
+    auto read = [&](void* target, size_t size){
+        if (static_cast<size_t>(end - cursor) < size) return false;
+        std::memcpy(target, cursor, size);
+        cursor += size;
+        return true;
+    };
+    for (uint16_t i = 0; i < record.header.fieldCount; ++i) {
+        BinaryField field;
+        field.unsignedInteger = 0;
+        if (!read(&field.type, 1)) return false;
+        switch (field.type) {
+        case BinaryFieldType::Bool: {
+            char value;
+            if (!read(&value, 1)) return false;
+            field.boolean = value != 0;
+            break;
+        }
+        case BinaryFieldType::Char:
+            if (!read(&field.character, 1)) return false;
+            break;
+        case BinaryFieldType::I32: {
+            int32_t value;
+            if (!read(&value, 4)) return false;
+            field.integer = value;
+            break;
+        }
+        case BinaryFieldType::U32: {
+            uint32_t value;
+            if (!read(&value, 4)) return false;
+            field.unsignedInteger = value;
+            break;
+        }
+        case BinaryFieldType::I64:
+            if (!read(&field.integer, 8)) return false;
+            break;
+        case BinaryFieldType::U64:
+            if (!read(&field.unsignedInteger, 8)) return false;
+            break;
+        case BinaryFieldType::F32: {
+            float value;
+            if (!read(&value, 4)) return false;
+            field.floating = value;
+            break;
+        }
+        case BinaryFieldType::F64:
+            if (!read(&field.floating, 8)) return false;
+            break;
+        case BinaryFieldType::String: {
+            uint32_t size;
+            if (!read(&size, 4) || static_cast<size_t>(end - cursor) < size) return false;
+            field.text = std::string_view(cursor, size);
+            cursor += size;
+            break;
+        }
+        default:
+            return false;
+        }
+        visit(static_cast<const BinaryField&>(field));
+    }
+    return true;
+}
+
+/* 调用点记录的内容 */
+struct BinaryCallsiteInfo{
+    uint32_t line { 0 };
+    std::string_view file;
+    std::string_view function;
+};
+
+inline bool DecodeBinaryCallsite(const BinaryRecordView& record, BinaryCallsiteInfo& info) noexcept{
+    const char* cursor = record.payload;
+    const char* end = record.payload + record.payloadSize;
+    auto readString = [&](std::string_view& out){
+        uint32_t size;
+        if (static_cast<size_t>(end - cursor) < sizeof(size)) return false;
+        std::memcpy(&size, cursor, sizeof(size));
+        cursor += sizeof(size);
+        if (static_cast<size_t>(end - cursor) < size) return false;
+        out = std::string_view(cursor, size);
+        cursor += size;
+        return true;
+    };
+    if (static_cast<size_t>(end - cursor) < sizeof(info.line)) return false;
+    std::memcpy(&info.line, cursor, sizeof(info.line));
+    cursor += sizeof(info.line);
+    return readString(info.file) && readString(info.function);
+}
+}
+
+/*
+ * @function: 写一条二进制日志, 调用点信息只在第一次使用时写入一次
+ * @note: 与 PRINT_AT 相同, 被关闭的级别不会求值参数
+ */
+#define PRINT_BINARY(level, log, ...)                                                  \
+    do {                                                                               \
+        const ::Tools::Level toolsLevel_ = (level);                                    \
+        if (::Tools::IsLevelEnabled(toolsLevel_)) {                                    \
+            static const ::Tools::BinaryCallsite toolsCallsite_{};                     \
+            (log).Log(toolsLevel_, toolsCallsite_, __VA_ARGS__);                       \
+        }                                                                              \
+    } while (0)
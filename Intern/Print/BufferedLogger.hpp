@@ -0,0 +1,240 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "DeferredFormat.hpp"
+#include "LineWriter.hpp"
+#include "LogSink.hpp"
+#include "Printable.hpp"
+
+namespace Tools{
+struct BufferedLoggerOptions{
+    size_t flushBytes { 16 * 1024 };                    /* 某个线程的缓冲达到这个大小时唤醒 flusher */
+    size_t maxBufferBytes { 256 * 1024 };               /* 达到这个大小时写日志的线程等待一次 Flush */
+    std::chrono::milliseconds flushInterval { 50 };     /* 最长多久 flush 一次 */
+};
+
+/*
+ * @function: 每线程追加缓冲 + 批量写出的日志前端
+ * @note: 每个线程把格式化好的行追加到自己的缓冲 (只和 flusher 竞争一把几乎无争用的锁)
+ * @note: flusher 线程在大小阈值, 定时或显式 Flush() 时交换出所有线程的缓冲, 合并成一次 sink.Write (FdSink 上是一次 writev)
+ * @note: 同一线程的日志保持顺序, 不同线程之间不保证全局顺序
+ * @Usage:
+    Tools::FileSink file("game.log");
+    Tools::BufferedLogger logger(file);
+    Tools::Print(logger, Tools::Level::Normal, "loaded ", count, " assets");
+ */
+class BufferedLogger{
+public:
+    explicit BufferedLogger(ILogSink& sink, BufferedLoggerOptions options = {})
+        : sink(sink), options(options), id(NextId()){
+        flusher = std::thread([this]{ FlusherLoop(); });
+    }
+
+    BufferedLogger(const BufferedLogger&) = delete;
+    BufferedLogger& operator=(const BufferedLogger&) = delete;
+
+    ~BufferedLogger(){
+        Stop();
+    }
+
+    template <typename... Args>
+    void Log([[maybe_unused]] Level level, const Args&... args){
+        Detail::LineWriter& writer = Detail::LocalLineWriter();
+        writer.record.clear();
+        (Detail::AppendArg(writer.record, args), ...);
+        writer.record.push_back('\n');
+        Append(writer.record.data(), writer.record.size());
+    }
+
+    /* 追加已经格式化好的字节 */
+    void Append(const char* data, size_t size){
+        if (stopped.load(std::memory_order_relaxed)) return ;
+        ThreadBuffer& buffer = LocalBuffer();
+        size_t buffered;
+        {
+            std::lock_guard<std::mutex> lock(buffer.mutex);
+            buffer.active.append(data, size);
+            buffered = buffer.active.size();
+        }
+        if (buffered >= options.maxBufferBytes) {
+            Flush();
+        } else if (buffered >= options.flushBytes) {
+            Wake();
+        }
+    }
+
+    /* 阻塞直到调用之前追加的日志全部写入 sink */
+    void Flush(){
+        if (stopped.load(std::memory_order_acquire)) return ;
+        const uint64_t ticket = flushRequests.fetch_add(1, std::memory_order_acq_rel) + 1;
+        Wake();
+        for (uint64_t done = flushed.load(std::memory_order_acquire); done < ticket;
+             done = flushed.load(std::memory_order_acquire)) {
+            flushed.wait(done, std::memory_order_acquire);
+        }
+    }
+
+    /* 写出所有缓冲后停止 flusher, 之后的日志会被丢弃; 各线程的缓冲在它们下次写日志 (任意 logger) 时释放 */
+    void Stop(){
+        if (stopped.exchange(true, std::memory_order_acq_rel)) return ;
+        Wake();
+        flusher.join();
+        std::lock_guard<std::mutex> lock(buffersMutex);
+        for (auto& buffer : buffers) {
+            buffer->retired.store(true, std::memory_order_relaxed);
+        }
+        buffers.clear();
+    }
+
+    /* sink 的 Write / Flush 抛出异常 (例如 FdSink 遇到 EPIPE / ENOSPC) 的次数, 失败的那一批日志被丢弃 */
+    uint64_t GetFailedWriteCount() const noexcept{
+        return failedWrites.load(std::memory_order_relaxed);
+    }
+
+private:
+    struct ThreadBuffer{
+        std::mutex mutex;
+        std::string active;             /* 写日志的线程追加到这里 */
+        std::string flushing;           /* 只由 flusher 使用 */
+        std::atomic<bool> closed { false };
+        std::atomic<bool> retired { false };    /* logger 已停止, 写日志的线程下次查找时释放自己的引用 */
+    };
+
+    /* 线程退出时把自己的缓冲标记为关闭; 已停止的 logger 的缓冲在查找时移除, 不会随线程一直保留 */
+    struct LocalBuffers{
+        ~LocalBuffers(){
+            for (auto& entry : entries) {
+                entry.second->closed.store(true, std::memory_order_release);
+            }
+        }
+        std::vector<std::pair<uint64_t, std::shared_ptr<ThreadBuffer>>> entries;
+    };
+
+    static uint64_t NextId() noexcept{
+        static std::atomic<uint64_t> counter { 0 };
+        return counter.fetch_add(1, std::memory_order_relaxed) + 1;
+    }
+
+    ThreadBuffer& LocalBuffer(){
+        thread_local LocalBuffers locals;
+        auto& entries = locals.entries;
+        for (size_t i = 0; i < entries.size();) {
+            if (entries[i].second->retired.load(std::memory_order_relaxed)) {
+                entries[i] = std::move(entries.back());
+                entries.pop_back();
+                continue;
+            }
+            if (entries[i].first == id) return *entries[i].second;
+            ++i;
+        }
+        auto buffer = std::make_shared<ThreadBuffer>();
+        buffer->active.reserve(options.flushBytes);
+        {
+            std::lock_guard<std::mutex> lock(buffersMutex);
+            /* 与 Stop 竞争时 (已经看过 stopped) 不再登记, 这个缓冲不会被写出, 下次查找时释放 */
+            if (stopped.load(std::memory_order_relaxed)) {
+                buffer->retired.store(true, std::memory_order_relaxed);
+            } else {
+                buffers.push_back(buffer);
+            }
+        }
+        locals.entries.emplace_back(id, buffer);
+        return *buffer;
+    }
+
+    void Wake(){
+        {
+            std::lock_guard<std::mutex> lock(wakeMutex);
+            wakeRequested = true;
+        }
+        wakeCv.notify_one();
+    }
+
+    /* 交换出所有线程的缓冲并一次写出 */
+    void FlushAll(){
+        std::lock_guard<std::mutex> lock(buffersMutex);
+        slices.clear();
+        for (auto it = buffers.begin(); it != buffers.end();) {
+            ThreadBuffer& buffer = **it;
+            const bool closed = buffer.closed.load(std::memory_order_acquire);
+            {
+                std::lock_guard<std::mutex> bufferLock(buffer.mutex);
+                buffer.active.swap(buffer.flushing);
+            }
+            if (!buffer.flushing.empty()) {
+                slices.push_back(LogSlice{ buffer.flushing.data(), buffer.flushing.size() });
+            }
+            ++it;
+            if (closed) pendingRemoval.push_back(*(it - 1));
+        }
+        if (!slices.empty()) {
+            /* sink 的异常不能逃出 flusher: 丢弃这一批并计数, 之后的日志继续尝试写入 */
+            try {
+                sink.Write(slices.data(), slices.size());
+                sink.Flush();
+            } catch (...) {
+                failedWrites.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+        for (auto& buffer : buffers) {
+            buffer->flushing.clear();
+        }
+        /* 线程已经退出且缓冲已写出, 移除 */
+        for (auto& buffer : pendingRemoval) {
+            std::erase(buffers, buffer);
+        }
+        pendingRemoval.clear();
+    }
+
+    void FlusherLoop(){
+        for (;;) {
+            const uint64_t request = flushRequests.load(std::memory_order_acquire);
+            const bool stopping = stopped.load(std::memory_order_acquire);
+            FlushAll();
+            if (request != flushed.load(std::memory_order_relaxed)) {
+                flushed.store(request, std::memory_order_release);
+                flushed.notify_all();
+            }
+            if (stopping) {
+                flushed.store(UINT64_MAX, std::memory_order_release);
+                flushed.notify_all();
+                return ;
+            }
+            std::unique_lock<std::mutex> lock(wakeMutex);
+            wakeCv.wait_for(lock, options.flushInterval, [this]{ return wakeRequested; });
+            wakeRequested = false;
+        }
+    }
+
+private:
+    ILogSink& sink;
+    BufferedLoggerOptions options;
+    const uint64_t id;
+
+    std::mutex buffersMutex;
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+    std::vector<std::shared_ptr<ThreadBuffer>> pendingRemoval;     /* 只由 flusher 使用 */
+    std::vector<LogSlice> slices;                                  /* 只由 flusher 使用 */
+
+    std::mutex wakeMutex;
+    std::condition_variable wakeCv;
+    bool wakeRequested { false };
+
+    std::atomic<bool> stopped { false };
+    std::atomic<uint64_t> flushRequests { 0 };
+    std::atomic<uint64_t> flushed { 0 };
+    std::atomic<uint64_t> failedWrites { 0 };
+    std::thread flusher;
+};
+
+}
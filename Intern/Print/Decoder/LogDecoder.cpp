@@ -0,0 +1,336 @@
+/*
+ * PrintLogDecoder: 把 Tools::BinaryLog 写出的二进制日志转换为文本或 JSON (每行一个对象)
+ *
+ * 用法: PrintLogDecoder [选项] 文件...
+ *   --json                输出 JSON Lines
+ *   --level <级别>        只输出不低于该级别的记录 (Debug / Normal / Warning / Error 或 0 ~ 3)
+ *   --thread <序号>       只输出该线程的记录, 可以重复
+ *   --since <时间>        只输出不早于该时间的记录
+ *   --until <时间>        只输出早于该时间的记录
+ *   --stats               在 stderr 输出扫描与匹配的记录数
+ * 时间可以是 UTC 的 "YYYY-MM-DD,HH-MM-SS[.ffff]" / "YYYY-MM-DDTHH:MM:SS[.ffff]", 或 system_clock 纳秒整数
+ *
+ * 同一次运行的多个文件 (例如 MappedFileSink 的各个段) 应该一起解码, 调用点的定义可能在其他文件中;
+ * MappedFileSink 的段按序号排序后拼接成一个流解码 (记录可能跨段), 参数的顺序无关紧要
+ * 过滤只读取记录头, 不匹配的记录不会解码字段
+ */
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "../BinaryLog.hpp"
+
+namespace {
+struct Filter{
+    int minLevel { 0 };
+    std::vector<uint32_t> threads;
+    int64_t since { INT64_MIN };
+    int64_t until { INT64_MAX };
+
+    bool Match(const Tools::BinaryRecordHeader& header) const{
+        if (header.level < minLevel) return false;
+        if (header.timestamp < since || header.timestamp >= until) return false;
+        if (!threads.empty() && std::find(threads.begin(), threads.end(), header.threadId) == threads.end()) return false;
+        return true;
+    }
+};
+
+struct Options{
+    bool json { false };
+    bool stats { false };
+    Filter filter;
+    std::vector<std::string> files;
+};
+
+const char* LevelName(uint8_t level){
+    switch (static_cast<Tools::Level>(level)) {
+    case Tools::Level::Debug: return "Debug";
+    case Tools::Level::Normal: return "Normal";
+    case Tools::Level::Warning: return "Warning";
+    case Tools::Level::Error: return "Error";
+    }
+    return "Unknown";
+}
+
+std::optional<int> ParseLevel(std::string_view text){
+    const char* names[] = { "Debug", "Normal", "Warning", "Error" };
+    for (int i = 0; i < 4; ++i) {
+        if (text == names[i]) return i;
+    }
+    int value = 0;
+    const auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+    if (result.ec == std::errc() && result.ptr == text.data() + text.size() && value >= 0 && value <= 3) return value;
+    return std::nullopt;
+}
+
+/* "YYYY-MM-DD,HH-MM-SS[.f]" / "YYYY-MM-DDTHH:MM:SS[.f]" (UTC) 或纳秒整数 */
+std::optional<int64_t> ParseTime(std::string_view text){
+    int64_t ns = 0;
+    const auto whole = std::from_chars(text.data(), text.data() + text.size(), ns);
+    if (whole.ec == std::errc() && whole.ptr == text.data() + text.size()) return ns;
+
+    int fields[6] = {};
+    const char* cursor = text.data();
+    const char* end = text.data() + text.size();
+    for (int i = 0; i < 6; ++i) {
+        const auto result = std::from_chars(cursor, end, fields[i]);
+        if (result.ec != std::errc()) return std::nullopt;
+        cursor = result.ptr;
+        if (i < 5) {
+            if (cursor == end) return std::nullopt;
+            ++cursor;           /* 跳过分隔符 '-' ',' 'T' ':' */
+        }
+    }
+    using namespace std::chrono;
+    const year_month_day ymd{ year(fields[0]), month(static_cast<unsigned>(fields[1])), day(static_cast<unsigned>(fields[2])) };
+    if (!ymd.ok()) return std::nullopt;
+    int64_t result = duration_cast<nanoseconds>(sys_days(ymd).time_since_epoch()).count();
+    result += ((int64_t(fields[3]) * 60 + fields[4]) * 60 + fields[5]) * 1000000000;
+    if (cursor != end && *cursor == '.') {
+        ++cursor;
+        int64_t scale = 100000000;
+        for (; cursor != end && *cursor >= '0' && *cursor <= '9'; ++cursor, scale /= 10) {
+            result += (*cursor - '0') * scale;
+        }
+    }
+    if (cursor != end) return std::nullopt;
+    return result;
+}
+
+bool ParseOptions(int argc, char** argv, Options& options){
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view arg = argv[i];
+        auto value = [&]() -> std::optional<std::string_view>{
+            if (i + 1 >= argc) return std::nullopt;
+            return std::string_view(argv[++i]);
+        };
+        if (arg == "--json") {
+            options.json = true;
+        } else if (arg == "--stats") {
+            options.stats = true;
+        } else if (arg == "--level") {
+            const auto text = value();
+            const auto level = text ? ParseLevel(*text) : std::nullopt;
+            if (!level) return false;
+            options.filter.minLevel = *level;
+        } else if (arg == "--thread") {
+            const auto text = value();
+            uint32_t thread = 0;
+            if (!text || std::from_chars(text->data(), text->data() + text->size(), thread).ec != std::errc()) return false;
+            options.filter.threads.push_back(thread);
+        } else if (arg == "--since" || arg == "--until") {
+            const auto text = value();
+            const auto time = text ? ParseTime(*text) : std::nullopt;
+            if (!time) return false;
+            (arg == "--since" ? options.filter.since : options.filter.until) = *time;
+        } else if (arg.starts_with("--")) {
+            return false;
+        } else {
+            options.files.emplace_back(arg);
+        }
+    }
+    return !options.files.empty();
+}
+
+void AppendJsonString(std::string& out, std::string_view text){
+    out.push_back('"');
+    for (const char ch : text) {
+        switch (ch) {
+        case '"': out += "\\\""; break;
+        case '\\': out += "\\\\"; break;
+        case '\n': out += "\\n"; break;
+        case '\r': out += "\\r"; break;
+        case '\t': out += "\\t"; break;
+        default:
+            if (static_cast<unsigned char>(ch) < 0x20) {
+                char escape[8];
+                std::snprintf(escape, sizeof(escape), "\\u%04x", static_cast<unsigned>(static_cast<unsigned char>(ch)));
+                out += escape;
+            } else {
+                out.push_back(ch);
+            }
+        }
+    }
+    out.push_back('"');
+}
+
+/* 与 Tools::Print 的文本一致: bool 输出 1/0, 浮点数相当于 %g */
+void AppendFieldText(std::string& out, const Tools::BinaryField& field){
+    using Tools::BinaryFieldType;
+    switch (field.type) {
+    case BinaryFieldType::Bool: Tools::Detail::ArgCodec<bool>::Append(out, field.boolean); break;
+    case BinaryFieldType::Char: out.push_back(field.character); break;
+    case BinaryFieldType::I32:
+    case BinaryFieldType::I64: Tools::Detail::ArgCodec<int64_t>::Append(out, field.integer); break;
+    case BinaryFieldType::U32:
+    case BinaryFieldType::U64: Tools::Detail::ArgCodec<uint64_t>::Append(out, field.unsignedInteger); break;
+    case BinaryFieldType::F32:
+    case BinaryFieldType::F64: Tools::Detail::ArgCodec<double>::Append(out, field.floating); break;
+    case BinaryFieldType::String: out.append(field.text); break;
+    }
+}
+
+void AppendFieldJson(std::string& out, const Tools::BinaryField& field){
+    using Tools::BinaryFieldType;
+    switch (field.type) {
+    case BinaryFieldType::Bool: out += field.boolean ? "true" : "false"; break;
+    case BinaryFieldType::Char: AppendJsonString(out, std::string_view(&field.character, 1)); break;
+    case BinaryFieldType::F32:
+    case BinaryFieldType::F64: {
+        /* JSON 没有 nan / inf */
+        if (field.floating != field.floating || field.floating - field.floating != 0.0) {
+            out += "null";
+        } else {
+            Tools::AppendTo(out, field.floating);
+        }
+        break;
+    }
+    case BinaryFieldType::String: AppendJsonString(out, field.text); break;
+    default: AppendFieldText(out, field); break;
+    }
+}
+
+struct Stats{
+    size_t records { 0 };
+    size_t matched { 0 };
+    size_t corrupt { 0 };
+};
+
+void Decode(const Options& options, const std::vector<std::string>& contents,
+            const std::unordered_map<uint32_t, Tools::BinaryCallsiteInfo>& callsites, Stats& stats){
+    std::string line;
+    std::string message;
+    char stamp[Tools::kTimestampMaxLength];
+    for (const std::string& content : contents) {
+        Tools::BinaryLogReader reader(content);
+        Tools::BinaryRecordView record;
+        while (reader.Next(record)) {
+            if (record.header.kind != Tools::BinaryRecordKind::Log) continue;
+            ++stats.records;
+            if (!options.filter.Match(record.header)) continue;
+            ++stats.matched;
+
+            const Tools::WallClock::time_point time{ std::chrono::nanoseconds(record.header.timestamp) };
+            const std::string_view timestamp(stamp, Tools::FormatTimestamp(stamp, time, 6));
+            const auto site = callsites.find(record.header.callsiteId);
+            line.clear();
+            message.clear();
+            if (options.json) {
+                std::string fields;
+                const bool complete = Tools::DecodeBinaryFields(record, [&](const Tools::BinaryField& field){
+                    AppendFieldText(message, field);
+                    if (!fields.empty()) fields.push_back(',');
+                    AppendFieldJson(fields, field);
+                });
+                if (!complete) ++stats.corrupt;
+                line += "{\"time\":";
+                AppendJsonString(line, timestamp);
+                line += ",\"ns\":";
+                Tools::AppendTo(line, record.header.timestamp);
+                line += ",\"level\":\"";
+                line += LevelName(record.header.level);
+                line += "\",\"thread\":";
+                Tools::AppendTo(line, record.header.threadId);
+                line += ",\"callsite\":";
+                Tools::AppendTo(line, record.header.callsiteId);
+                if (site != callsites.end()) {
+                    line += ",\"file\":";
+                    AppendJsonString(line, site->second.file);
+                    line += ",\"line\":";
+                    Tools::AppendTo(line, site->second.line);
+                    line += ",\"function\":";
+                    AppendJsonString(line, site->second.function);
+                }
+                line += ",\"message\":";
+                AppendJsonString(line, message);
+                line += ",\"fields\":[";
+                line += fields;
+                line += "]}\n";
+            } else {
+                line += timestamp;
+                line += " [";
+                line += LevelName(record.header.level);
+                line += "] [T";
+                Tools::AppendTo(line, record.header.threadId);
+                line += "] ";
+                if (site != callsites.end()) {
+                    const std::string_view file = site->second.file;
+                    line += file.substr(file.find_last_of("/\\") + 1);
+                    line.push_back(':');
+                    Tools::AppendTo(line, site->second.line);
+                } else {
+                    line += "callsite#";
+                    Tools::AppendTo(line, record.header.callsiteId);
+                }
+                line += ": ";
+                if (!Tools::DecodeBinaryFields(record, [&](const Tools::BinaryField& field){ AppendFieldText(line, field); })) {
+                    ++stats.corrupt;
+                }
+                line.push_back('\n');
+            }
+            std::fwrite(line.data(), 1, line.size(), stdout);
+        }
+        if (reader.GetOffset() < content.size()) {
+            /* 流的末尾是 MappedFileSink 崩溃时正在写的段, 其 '\0' 填充不算错误 */
+            const bool padding = std::all_of(content.begin() + static_cast<std::ptrdiff_t>(reader.GetOffset()), content.end(),
+                                             [](char ch){ return ch == '\0'; });
+            if (!padding) ++stats.corrupt;
+        }
+    }
+}
+}
+
+int main(int argc, char** argv){
+    Options options;
+    if (!ParseOptions(argc, argv, options)) {
+        std::cerr << "usage: " << argv[0]
+                  << " [--json] [--level L] [--thread N]... [--since TIME] [--until TIME] [--stats] file...\n";
+        return 2;
+    }
+
+    /* 每个流 (例如一个 basePath 的全部段) 拼接为一段连续的字节, 由一个 reader 解码 */
+    std::vector<std::string> contents;
+    for (const std::vector<std::string>& stream : Tools::GroupBinaryLogStreams(options.files)) {
+        std::string& content = contents.emplace_back();
+        for (const std::string& path : stream) {
+            std::ifstream file(path, std::ios::binary);
+            if (!file) {
+                std::cerr << "cannot open " << path << "\n";
+                return 1;
+            }
+            content.append(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        }
+    }
+
+    /* 第一遍: 只收集调用点定义, Log 记录按 size 跳过 */
+    std::unordered_map<uint32_t, Tools::BinaryCallsiteInfo> callsites;
+    for (const std::string& content : contents) {
+        Tools::BinaryLogReader reader(content);
+        Tools::BinaryRecordView record;
+        while (reader.Next(record)) {
+            Tools::BinaryCallsiteInfo info;
+            if (record.header.kind == Tools::BinaryRecordKind::Callsite && Tools::DecodeBinaryCallsite(record, info)) {
+                callsites.emplace(record.header.callsiteId, info);
+            }
+        }
+    }
+
+    Stats stats;
+    Decode(options, contents, callsites, stats);
+    std::fflush(stdout);
+    if (options.stats) {
+        std::cerr << "records: " << stats.records << ", matched: " << stats.matched
+                  << ", callsites: " << callsites.size() << ", corrupt: " << stats.corrupt << "\n";
+    }
+    return stats.corrupt == 0 ? 0 : 1;
+}
@@ -0,0 +1,254 @@
+#pragma once
+
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include "PrintTools.hpp"
+#if defined(__cpp_lib_format)
+  #include <format>
+  #include <iterator>
+#endif
+
+namespace Tools::Detail{
+/*
+ * @function: 延迟格式化的参数编码
+ * @note: 调用线程只把参数的原始字节追加到记录里, 后台线程再解码并转换为文本
+ * @note: 支持的参数: 算术类型 (按字节拷贝), 字符串 (std::string / std::string_view / const char* / 字符数组, 拷贝内容)
+ * @      其余类型不能延迟, Print 会退回到调用线程上格式化
+ * @note: 文本输出与调用线程上的 AppendArg 相同 (bool 输出 1/0, 浮点数相当于 %g), 切换模式不改变日志内容
+ */
+template <typename Ty, typename = void>
+struct ArgCodec{
+    static constexpr bool kDeferrable = false;
+};
+
+template <typename Ty>
+inline constexpr bool kIsCharLike = std::is_same_v<Ty, char> || std::is_same_v<Ty, signed char> ||
+                                    std::is_same_v<Ty, unsigned char>;
+template <typename Ty>
+inline constexpr bool kIsWideChar = std::is_same_v<Ty, wchar_t> || std::is_same_v<Ty, char8_t> ||
+                                    std::is_same_v<Ty, char16_t> || std::is_same_v<Ty, char32_t>;
+
+/* 算术类型 */
+template <typename Ty>
+struct ArgCodec<Ty, std::enable_if_t<std::is_arithmetic_v<Ty> && !kIsWideChar<Ty>>>{
+    static constexpr bool kDeferrable = true;
+    using Decoded = Ty;
+
+    static void Encode(std::string& out, Ty value){
+        out.append(reinterpret_cast<const char*>(&value), sizeof(Ty));
+    }
+    static Decoded Decode(const char*& cursor) noexcept{
+        Ty value;
+        std::memcpy(&value, cursor, sizeof(Ty));
+        cursor += sizeof(Ty);
+        return value;
+    }
+    /* 与调用线程上的 AppendArg 相同的格式 */
+    template <typename Buffer>
+    static void Append(Buffer& out, Ty value){
+        AppendValue<true>(out, value);
+    }
+};
+
+/* 字符串: [uint32 长度 | 内容] */
+struct StringCodec{
+    static constexpr bool kDeferrable = true;
+    using Decoded = std::string_view;
+
+    static void Encode(std::string& out, std::string_view value){
+        const uint32_t size = static_cast<uint32_t>(value.size());
+        out.append(reinterpret_cast<const char*>(&size), sizeof(size));
+        out.append(value.data(), size);
+    }
+    static Decoded Decode(const char*& cursor) noexcept{
+        uint32_t size;
+        std::memcpy(&size, cursor, sizeof(size));
+        cursor += sizeof(size);
+        const std::string_view value(cursor, size);
+        cursor += size;
+        return value;
+    }
+    template <typename Buffer>
+    static void Append(Buffer& out, std::string_view value){
+        out.append(value.data(), value.size());
+    }
+};
+
+template <>
+struct ArgCodec<std::string> : StringCodec {};
+template <>
+struct ArgCodec<std::string_view> : StringCodec {};
+template <>
+struct ArgCodec<const char*> : StringCodec{
+    static void Encode(std::string& out, const char* value){
+        StringCodec::Encode(out, value ? std::string_view(value) : std::string_view("nullptr"));
+    }
+};
+template <>
+struct ArgCodec<char*> : ArgCodec<const char*> {};
+template <size_t N>
+struct ArgCodec<char[N]> : StringCodec{
+    static void Encode(std::string& out, const char (&value)[N]){
+        StringCodec::Encode(out, std::string_view(value, std::char_traits<char>::length(value)));
+    }
+};
+
+template <typename Ty>
+using CodecOf = ArgCodec<std::remove_cv_t<std::remove_reference_t<Ty>>>;
+
+template <typename... Args>
+inline constexpr bool kAllDeferrable = (CodecOf<Args>::kDeferrable && ...);
+
+/*
+ * @function: 在调用线程上把一个参数追加到 out (Print / 日志使用)
+ * @note: 算术类型与 std::ostream 的默认格式一致, 与延迟格式化的结果相同; 容器, optional, pair 等内部的算术类型也一样
+ * @note: 与 operator<< 的差异: 不使用 stream 的格式标志 (宽度, 精度, hex, boolalpha 等) 与 locale;
+ * @      指针总是输出 "0x" + 十六进制 (空指针为 "0x0"); 空的 const char* 与 nullptr 输出 "nullptr";
+ * @      enum 输出底层整数; 其余格式见 AppendTo
+ */
+template <typename Buffer, typename Ty>
+void AppendArg(Buffer& out, const Ty& value){
+    AppendValue<true>(out, value);
+}
+
+template <typename... Args>
+void EncodeArgs(std::string& out, const Args&... args){
+    (CodecOf<Args>::Encode(out, args), ...);
+}
+
+template <typename... Args>
+std::tuple<typename CodecOf<Args>::Decoded...> DecodeArgs(const char* cursor){
+    /* 花括号初始化保证从左到右求值 */
+    return std::tuple<typename CodecOf<Args>::Decoded...>{ CodecOf<Args>::Decode(cursor)... };
+}
+
+/* Print 风格: 参数依次拼接, 末尾换行 */
+template <typename... Args>
+void RenderConcat(const char* payload, [[maybe_unused]] size_t size, std::string& out){
+    auto decoded = DecodeArgs<Args...>(payload);
+    std::apply([&out](const auto&... values){
+        (CodecOf<Args>::Append(out, values), ...);
+    }, decoded);
+    out.push_back('\n');
+}
+
+/*
+ * 格式串风格: payload 开头是格式串的地址和长度 (格式串来自 FormatLiteral, 是字面量)
+ * 有 <format> 时交给 std::vformat_to; 否则只支持 "{}" 以及 "{{" "}}" 转义, 占位符中的格式说明会被忽略
+ */
+template <typename... Args>
+void RenderFormat(const char* payload, [[maybe_unused]] size_t size, std::string& out){
+    const char* format;
+    size_t formatSize;
+    std::memcpy(&format, payload, sizeof(format));
+    std::memcpy(&formatSize, payload + sizeof(format), sizeof(formatSize));
+    auto decoded = DecodeArgs<Args...>(payload + sizeof(format) + sizeof(formatSize));
+    const std::string_view fmt(format, formatSize);
+#if defined(__cpp_lib_format)
+    /* 格式串已在编译期检查过, 这里兜底: 后台线程上不能让异常逃出 */
+    const size_t start = out.size();
+    try {
+        std::apply([&](const auto&... values){
+            std::vformat_to(std::back_inserter(out), fmt, std::make_format_args(values...));
+        }, decoded);
+    } catch (const std::format_error&) {
+        out.resize(start);
+        out.append("<format error> ");
+        out.append(fmt);
+    }
+#else
+    std::apply([&](const auto&... values){
+        void (*appenders[])(std::string&, const void*) = {
+            [](std::string& target, const void* value){
+                using Codec = CodecOf<Args>;
+                Codec::Append(target, *static_cast<const typename Codec::Decoded*>(value));
+            }..., nullptr
+        };
+        const void* pointers[] = { static_cast<const void*>(&values)..., nullptr };
+        size_t next = 0;
+        for (size_t i = 0; i < fmt.size(); ++i) {
+            const char ch = fmt[i];
+            if ((ch == '{' || ch == '}') && i + 1 < fmt.size() && fmt[i + 1] == ch) {
+                out.push_back(ch);
+                ++i;
+            } else if (ch == '{') {
+                const size_t close = fmt.find('}', i);
+                if (close == std::string_view::npos) {
+                    out.append(fmt.substr(i));
+                    break;
+                }
+                if (next < sizeof...(Args)) {
+                    appenders[next](out, pointers[next]);
+                    ++next;
+                }
+                i = close;
+            } else {
+                out.push_back(ch);
+            }
+        }
+    }, decoded);
+#endif
+    out.push_back('\n');
+}
+
+/* 没有 <format> 时的编译期检查: 统计 "{...}" 占位符 ("{{" "}}" 为转义), 括号不配对时返回 -1 */
+consteval int CountPlaceholders(std::string_view format){
+    int count = 0;
+    for (size_t i = 0; i < format.size(); ++i) {
+        const char ch = format[i];
+        if ((ch == '{' || ch == '}') && i + 1 < format.size() && format[i + 1] == ch) {
+            ++i;
+        } else if (ch == '{') {
+            const size_t close = format.find('}', i);
+            if (close == std::string_view::npos) return -1;
+            ++count;
+            i = close;
+        } else if (ch == '}') {
+            return -1;
+        }
+    }
+    return count;
+}
+
+/*
+ * @function: PrintFormat / LogFormat 的格式串参数, 只能由字符串字面量 (字符数组) 在编译期构造
+ * @note: 队列里只保存格式串的地址, 不接受 std::string / std::string_view, 避免悬垂
+ * @note: 有 <format> 时用 std::format_string 按解码后的参数类型检查格式串, 错误在编译期报告而不是在后台线程上抛出;
+ * @      否则检查占位符数量与参数个数一致
+ */
+template <typename... Args>
+struct BasicFormatLiteral{
+    template <size_t N>
+    consteval BasicFormatLiteral(const char (&literal)[N])
+        : text(literal, N - 1){
+#if defined(__cpp_lib_format)
+        [[maybe_unused]] std::format_string<typename CodecOf<Args>::Decoded...> checked(literal);
+#else
+        if (CountPlaceholders(text) != static_cast<int>(sizeof...(Args))) {
+            throw "format string does not match the number of arguments";
+        }
+#endif
+    }
+
+    std::string_view text;
+};
+
+/* 参数类型只从实参推导, 格式串不参与推导 */
+template <typename... Args>
+using FormatLiteral = BasicFormatLiteral<std::type_identity_t<Args>...>;
+
+template <typename... Args>
+void EncodeFormat(std::string& out, std::string_view format, const Args&... args){
+    const char* data = format.data();
+    const size_t size = format.size();
+    out.append(reinterpret_cast<const char*>(&data), sizeof(data));
+    out.append(reinterpret_cast<const char*>(&size), sizeof(size));
+    EncodeArgs(out, args...);
+}
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <ostream>
+#include <streambuf>
+#include <string>
+
+namespace Tools::Detail{
+/* 追加到 std::string 的 streambuf, 清空字符串后可以复用, 不会重复分配 */
+class StringAppendBuf : public std::streambuf{
+public:
+    void SetTarget(std::string* target) noexcept{
+        this->target = target;
+    }
+protected:
+    int_type overflow(int_type ch) override{
+        if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+            target->push_back(traits_type::to_char_type(ch));
+        }
+        return traits_type::not_eof(ch);
+    }
+    std::streamsize xsputn(const char* data, std::streamsize count) override{
+        target->append(data, static_cast<size_t>(count));
+        return count;
+    }
+private:
+    std::string* target { nullptr };
+};
+
+/* 每个线程一份的格式化现场 */
+struct LineWriter{
+    LineWriter() : stream(&buf) {
+        buf.SetTarget(&record);
+    }
+    std::string record;
+    StringAppendBuf buf;
+    std::ostream stream;
+};
+
+inline LineWriter& LocalLineWriter(){
+    thread_local LineWriter writer;
+    return writer;
+}
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <atomic>
+
+/*
+ * 编译期最低日志级别, 低于它的 PRINT_XXX 宏展开为空, 参数不会被求值
+ * CMake 中通过 LOG_MIN_LEVEL (Debug / Normal / Warning / Error / Off) 设置, 默认全部编译进来
+ */
+#define TOOLS_LOG_LEVEL_DEBUG   0
+#define TOOLS_LOG_LEVEL_NORMAL  1
+#define TOOLS_LOG_LEVEL_WARNING 2
+#define TOOLS_LOG_LEVEL_ERROR   3
+#define TOOLS_LOG_LEVEL_OFF     4
+
+#if !defined(TOOLS_LOG_MIN_LEVEL)
+    #define TOOLS_LOG_MIN_LEVEL TOOLS_LOG_LEVEL_DEBUG
+#endif
+
+namespace Tools{
+enum class Level{
+    Debug = TOOLS_LOG_LEVEL_DEBUG,
+    Normal = TOOLS_LOG_LEVEL_NORMAL,
+    Warning = TOOLS_LOG_LEVEL_WARNING,
+    Error = TOOLS_LOG_LEVEL_ERROR
+};
+
+/* 该级别是否被编译进来 */
+constexpr bool IsLevelCompiledIn(Level level) noexcept{
+    return static_cast<int>(level) >= TOOLS_LOG_MIN_LEVEL;
+}
+
+namespace Detail{
+inline std::atomic<int> runtimeLevel { TOOLS_LOG_MIN_LEVEL };
+}
+
+/* 运行期阈值, 低于它的日志被丢弃; 不能低于编译期的最低级别 */
+inline void SetLogLevel(Level level) noexcept{
+    Detail::runtimeLevel.store(static_cast<int>(level), std::memory_order_relaxed);
+}
+inline Level GetLogLevel() noexcept{
+    return static_cast<Level>(Detail::runtimeLevel.load(std::memory_order_relaxed));
+}
+
+/* 编译期检查 + 一次 relaxed 原子读 */
+inline bool IsLevelEnabled(Level level) noexcept{
+    return IsLevelCompiledIn(level) &&
+           static_cast<int>(level) >= Detail::runtimeLevel.load(std::memory_order_relaxed);
+}
+}
+
+/*
+ * @function: 带级别过滤的 Tools::Print
+ * @note: 编译期被裁掉的级别整条语句展开为空; 运行期被关闭的级别只有一次 relaxed 原子读, 参数不会被求值
+ * @note: level 只求值一次, 级别只检查一次 (之后调用不再检查的 Detail::PrintEnabled, 需要包含 Print.hpp)
+ * @Usage:
+    PRINT_DEBUG(std::cout, "visible objects: ", CountVisible());     // Release 中 LOG_MIN_LEVEL=Normal 时不会调用 CountVisible
+    PRINT_ERROR(logger, "failed to open ", path);
+    PRINT_AT(level, logger, "dynamic level");
+ */
+#define PRINT_AT(level, target, ...)                                          \
+    do {                                                                      \
+        const ::Tools::Level toolsLevel_ = (level);                           \
+        if (::Tools::IsLevelEnabled(toolsLevel_)) {                           \
+            ::Tools::Detail::PrintEnabled(target, toolsLevel_, __VA_ARGS__);  \
+        }                                                                     \
+    } while (0)
+
+#if TOOLS_LOG_MIN_LEVEL <= TOOLS_LOG_LEVEL_DEBUG
+    #define PRINT_DEBUG(target, ...) PRINT_AT(::Tools::Level::Debug, target, __VA_ARGS__)
+#else
+    #define PRINT_DEBUG(target, ...) do {} while (0)
+#endif
+
+#if TOOLS_LOG_MIN_LEVEL <= TOOLS_LOG_LEVEL_NORMAL
+    #define PRINT_NORMAL(target, ...) PRINT_AT(::Tools::Level::Normal, target, __VA_ARGS__)
+#else
+    #define PRINT_NORMAL(target, ...) do {} while (0)
+#endif
+
+#if TOOLS_LOG_MIN_LEVEL <= TOOLS_LOG_LEVEL_WARNING
+    #define PRINT_WARNING(target, ...) PRINT_AT(::Tools::Level::Warning, target, __VA_ARGS__)
+#else
+    #define PRINT_WARNING(target, ...) do {} while (0)
+#endif
+
+#if TOOLS_LOG_MIN_LEVEL <= TOOLS_LOG_LEVEL_ERROR
+    #define PRINT_ERROR(target, ...) PRINT_AT(::Tools::Level::Error, target, __VA_ARGS__)
+#else
+    #define PRINT_ERROR(target, ...) do {} while (0)
+#endif
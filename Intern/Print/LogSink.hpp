@@ -0,0 +1,147 @@
+#pragma once
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#if defined(__linux__) || defined(__APPLE__)
+  #include <fcntl.h>
+  #include <sys/uio.h>
+  #include <unistd.h>
+  #define TOOLS_HAS_POSIX_SINK 1
+#endif
+
+namespace Tools{
+/* 一段待写入的字节, 与 iovec 对应 */
+struct LogSlice{
+    const char* data { nullptr };
+    size_t size { 0 };
+};
+
+/*
+ * @function: 日志的最终输出目标
+ * @note: Write 一次接收多段数据, 实现应尽量合并成一次系统调用
+ * @note: 只会被一个线程 (logger 的后台线程或 flusher) 调用, 实现不需要加锁
+ */
+class ILogSink{
+public:
+    virtual ~ILogSink() = default;
+    virtual void Write(const LogSlice* slices, size_t count) = 0;
+    virtual void Flush() {}
+};
+
+/* 写入 std::ostream, 用于测试或没有 fd 的平台 */
+class OstreamSink final : public ILogSink{
+public:
+    explicit OstreamSink(std::ostream& stream)
+        : stream(stream) {}
+
+    void Write(const LogSlice* slices, size_t count) override{
+        for (size_t i = 0; i < count; ++i) {
+            stream.write(slices[i].data, static_cast<std::streamsize>(slices[i].size));
+        }
+    }
+    void Flush() override{
+        stream.flush();
+    }
+
+private:
+    std::ostream& stream;
+};
+
+#if defined(TOOLS_HAS_POSIX_SINK)
+/*
+ * @function: 写入文件描述符, 多段数据合并为一次 writev
+ * @note: 处理 EINTR 与部分写入; 超过 IOV_MAX 段时分多次调用
+ * @note: 写失败时抛出 std::system_error; AsyncLogger / BufferedLogger 捕获后丢弃这一批并计数 (GetFailedWriteCount)
+ */
+class FdSink : public ILogSink{
+public:
+    explicit FdSink(int fd, bool ownsFd = false)
+        : fd(fd), ownsFd(ownsFd) {}
+
+    FdSink(const FdSink&) = delete;
+    FdSink& operator=(const FdSink&) = delete;
+
+    ~FdSink() override{
+        if (ownsFd && fd >= 0) ::close(fd);
+    }
+
+    void Write(const LogSlice* slices, size_t count) override{
+        iovecs.clear();
+        for (size_t i = 0; i < count; ++i) {
+            if (slices[i].size == 0) continue;
+            iovecs.push_back(iovec{ const_cast<char*>(slices[i].data), slices[i].size });
+        }
+        size_t first = 0;
+        while (first < iovecs.size()) {
+            const int batch = static_cast<int>(std::min<size_t>(iovecs.size() - first, kMaxIov));
+            const ssize_t written = ::writev(fd, iovecs.data() + first, batch);
+            if (written < 0) {
+                if (errno == EINTR) continue;
+                throw std::system_error(errno, std::generic_category(), "FdSink writev");
+            }
+            /* 跳过已经写完的段, 调整写了一半的段 */
+            size_t remaining = static_cast<size_t>(written);
+            while (first < iovecs.size() && remaining >= iovecs[first].iov_len) {
+                remaining -= iovecs[first].iov_len;
+                ++first;
+            }
+            if (remaining > 0) {
+                iovecs[first].iov_base = static_cast<char*>(iovecs[first].iov_base) + remaining;
+                iovecs[first].iov_len -= remaining;
+            }
+        }
+        ++writeCalls;
+    }
+
+    int GetFd() const noexcept{
+        return fd;
+    }
+    /* Write 被调用的次数, 用于观察合并效果 */
+    size_t GetWriteCalls() const noexcept{
+        return writeCalls;
+    }
+
+private:
+    static constexpr size_t kMaxIov = 1024;     /* Linux 与 macOS 的 IOV_MAX */
+
+    int fd { -1 };
+    bool ownsFd { false };
+    size_t writeCalls { 0 };
+    std::vector<iovec> iovecs;
+};
+
+/* 标准输出 */
+class StdoutSink final : public FdSink{
+public:
+    StdoutSink()
+        : FdSink(STDOUT_FILENO, false) {}
+};
+
+/* 以追加方式打开的文件, 打开失败时抛出 std::system_error */
+class FileSink final : public FdSink{
+public:
+    explicit FileSink(const std::string& path)
+        : FdSink(Open(path), true) {}
+
+    /* 落盘; Flush 不做 fsync, 写入内核后就算完成 */
+    void Sync(){
+        ::fsync(GetFd());
+    }
+
+private:
+    static int Open(const std::string& path){
+        const int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+        if (fd < 0) {
+            throw std::system_error(errno, std::generic_category(), "open " + path);
+        }
+        return fd;
+    }
+};
+#endif
+}
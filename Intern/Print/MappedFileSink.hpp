@@ -0,0 +1,324 @@
+#pragma once
+
+#include "LogSink.hpp"
+
+#if defined(TOOLS_HAS_POSIX_SINK)
+
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace Tools{
+struct MappedFileSinkOptions{
+    size_t segmentBytes { 64 * 1024 * 1024 };   /* 每个文件段的大小, 会向上取整到页大小 */
+    size_t maxSegments { 0 };                   /* 最多保留的段数, 超过时删除最旧的; 0 表示全部保留 */
+    bool prefault { true };                     /* 预分配时提前触发缺页, 写日志时不再缺页 */
+};
+
+/*
+ * @function: 写入内存映射文件段的 sink, 一次 Write 就是一次 memcpy
+ * @note: 文件名为 "<basePath>.<序号>", 序号从 0 开始; 已存在的同名文件会被覆盖
+ * @note: 后台线程提前创建并映射好下一个段, 当前段写满时直接切换过去, 写日志的线程不等待文件增长
+ * @note: 写满的段交给后台线程截断到实际长度并关闭, 所以正常关闭的段末尾没有多余的 '\0'
+ * @note: 进程崩溃时已经 memcpy 进映射的数据仍在页缓存中, 由内核写回; 崩溃时正在写的段末尾会留下 '\0' 填充
+ * @      断电不在此列, 需要时调用 Sync()
+ * @note: maxSegments 不计入预分配好但还没开始写的下一个段
+ * @note: 一次 Write 中的数据尽量在 '\n' 处切分到下一个段, 单行超过剩余空间时才会被截断成两段;
+ * @      二进制数据中的 '\n' 只是普通字节, 记录会跨段, 段需要按序号拼接后再解码
+ * @note: 无法创建下一个段 (例如磁盘满) 时 Write 不抛出异常: 留在当前段, 丢弃这次 Write 中放不下的数据并计数 (GetDroppedBytes),
+ * @      之后的 Write 会再次尝试切换
+ * @Usage:
+    Tools::MappedFileSink sink("logs/game.log", { .segmentBytes = 256 << 20 });
+    Tools::AsyncLogger logger(sink);
+ */
+class MappedFileSink final : public ILogSink{
+public:
+    explicit MappedFileSink(std::string basePath, MappedFileSinkOptions options = {})
+        : basePath(std::move(basePath)), options(options){
+        const size_t page = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+        this->options.segmentBytes = (options.segmentBytes + page - 1) / page * page;
+        if (this->options.segmentBytes == 0) this->options.segmentBytes = page;
+        current = CreateSegment(0);
+        nextIndex = 1;
+        worker = std::thread([this]{ WorkerLoop(); });
+    }
+
+    MappedFileSink(const MappedFileSink&) = delete;
+    MappedFileSink& operator=(const MappedFileSink&) = delete;
+
+    ~MappedFileSink() override{
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        cv.notify_one();
+        worker.join();
+        /* 后台线程已经退出, 剩余的段在这里收尾 */
+        for (Segment& segment : retired) RetireSegment(segment);
+        FinishSegment(current);
+        /* 没用上的预分配段直接删除 */
+        if (ready.data) {
+            const std::string path = PathOf(ready.index);
+            FinishSegment(ready, 0);
+            std::remove(path.c_str());
+        }
+    }
+
+    void Write(const LogSlice* slices, size_t count) override{
+        for (size_t i = 0; i < count; ++i) {
+            const char* data = slices[i].data;
+            size_t size = slices[i].size;
+            while (size > 0) {
+                const size_t room = current.size - current.used;
+                size_t take = size;
+                if (size > room) {
+                    /* 放不下时在最后一个换行处切分; 空段放不下一行时只能截断 */
+                    const void* newline = MemRChr(data, room);
+                    take = newline ? static_cast<size_t>(static_cast<const char*>(newline) - data) + 1
+                                   : (current.used == 0 ? room : 0);
+                }
+                std::memcpy(current.data + current.used, data, take);
+                current.used += take;
+                data += take;
+                size -= take;
+                if (size > 0 && !Rotate()) {
+                    for (size_t rest = i + 1; rest < count; ++rest) size += slices[rest].size;
+                    droppedBytes += size;
+                    return ;
+                }
+            }
+        }
+    }
+
+    /* 数据已经在映射中, 不需要 flush */
+    void Flush() override {}
+
+    /* 把当前段已写入的部分同步到磁盘 */
+    void Sync(){
+        if (current.used > 0) ::msync(current.data, current.used, MS_SYNC);
+    }
+
+    /* 切换段时预分配没跟上的次数, 用于调整 segmentBytes */
+    size_t GetStallCount() const noexcept{
+        return stalls;
+    }
+    /* 无法创建新段而丢弃的字节数 */
+    size_t GetDroppedBytes() const noexcept{
+        return droppedBytes;
+    }
+    size_t GetSegmentBytes() const noexcept{
+        return options.segmentBytes;
+    }
+
+private:
+    struct Segment{
+        int fd { -1 };
+        char* data { nullptr };
+        size_t size { 0 };
+        size_t used { 0 };
+        size_t index { 0 };
+    };
+
+    static const void* MemRChr(const char* data, size_t size) noexcept{
+        for (size_t i = size; i > 0; --i) {
+            if (data[i - 1] == '\n') return data + i - 1;
+        }
+        return nullptr;
+    }
+
+    std::string PathOf(size_t index) const{
+        return basePath + "." + std::to_string(index);
+    }
+
+    Segment CreateSegment(size_t index) const{
+        const std::string path = PathOf(index);
+        Segment segment;
+        segment.index = index;
+        segment.size = options.segmentBytes;
+        segment.fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (segment.fd < 0) {
+            throw std::system_error(errno, std::generic_category(), "open " + path);
+        }
+#if defined(__linux__)
+        /* 真正分配磁盘块, 写入映射时不会因为磁盘满而 SIGBUS */
+        const int error = ::posix_fallocate(segment.fd, 0, static_cast<off_t>(segment.size));
+#else
+        const int error = ::ftruncate(segment.fd, static_cast<off_t>(segment.size)) == 0 ? 0 : errno;
+#endif
+        if (error != 0) {
+            ::close(segment.fd);
+            throw std::system_error(error, std::generic_category(), "allocate " + path);
+        }
+        int flags = MAP_SHARED;
+#if defined(MAP_POPULATE)
+        if (options.prefault) flags |= MAP_POPULATE;
+#endif
+        void* data = ::mmap(nullptr, segment.size, PROT_READ | PROT_WRITE, flags, segment.fd, 0);
+        if (data == MAP_FAILED) {
+            const int mapError = errno;
+            ::close(segment.fd);
+            throw std::system_error(mapError, std::generic_category(), "mmap " + path);
+        }
+        segment.data = static_cast<char*>(data);
+#if !defined(MAP_POPULATE)
+        if (options.prefault) {
+            const size_t page = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+            for (size_t offset = 0; offset < segment.size; offset += page) segment.data[offset] = 0;
+        }
+#endif
+        return segment;
+    }
+
+    /* 解除映射并把文件截断到实际写入的长度 */
+    static void FinishSegment(Segment& segment, size_t length){
+        if (!segment.data) return ;
+        ::munmap(segment.data, segment.size);
+        if (::ftruncate(segment.fd, static_cast<off_t>(length)) != 0) {
+            /* 截断失败只会在末尾留下 '\0' 填充, 不影响已经写入的数据 */
+        }
+        ::close(segment.fd);
+        segment = Segment{};
+    }
+    static void FinishSegment(Segment& segment){
+        FinishSegment(segment, segment.used);
+    }
+
+    /* 关闭写满的段, 并删除超出 maxSegments 的旧段 (当前段 + 已关闭的段不超过 maxSegments) */
+    void RetireSegment(Segment& segment) const{
+        const size_t index = segment.index;
+        FinishSegment(segment);
+        if (options.maxSegments > 0 && index + 1 >= options.maxSegments) {
+            std::remove(PathOf(index + 1 - options.maxSegments).c_str());
+        }
+    }
+
+    /* 分配下一个序号, 优先使用上次创建失败留下的序号; 调用时持有 mutex */
+    size_t TakeIndex() noexcept{
+        if (hasSpareIndex) {
+            hasSpareIndex = false;
+            return spareIndex;
+        }
+        return nextIndex++;
+    }
+    /* 创建失败, 序号留给下一次创建, 保证文件序号连续 (maxSegments 按序号删除旧段); 调用时持有 mutex */
+    void ReleaseIndex(size_t index) noexcept{
+        spareIndex = index;
+        hasSpareIndex = true;
+    }
+
+    /*
+     * 换到预分配好的段; 后台线程没在创建时才在当前线程上创建. 同一时刻只有一个线程在创建段 (creating), 保证序号连续
+     * 创建失败时保留当前段并返回 false
+     */
+    bool Rotate(){
+        Segment next;
+        size_t index = 0;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            if (!ready.data) ++stalls;
+            readyCv.wait(lock, [this]{ return ready.data || !creating; });
+            if (ready.data) {
+                next = ready;
+                ready = Segment{};
+            } else {
+                index = TakeIndex();
+                creating = true;
+            }
+        }
+        if (!next.data) {
+            bool failed = false;
+            try {
+                next = CreateSegment(index);
+            } catch (const std::system_error&) {
+                failed = true;
+            }
+            std::lock_guard<std::mutex> lock(mutex);
+            creating = false;
+            if (failed) ReleaseIndex(index);
+            readyCv.notify_all();
+            if (failed) return false;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            retired.push_back(current);
+        }
+        current = next;
+        cv.notify_one();
+        return true;
+    }
+
+    void WorkerLoop(){
+        std::unique_lock<std::mutex> lock(mutex);
+        for (;;) {
+            cv.wait(lock, [this]{ return stopping || !retired.empty() || (!ready.data && !preallocFailed && !creating); });
+            if (stopping) return ;
+
+            std::deque<Segment> finishing;
+            finishing.swap(retired);
+            /* 预分配失败后等到下一次切换再重试, 避免空转 */
+            if (!finishing.empty()) preallocFailed = false;
+            const bool needReady = !ready.data && !preallocFailed && !creating;
+            size_t index = 0;
+            if (needReady) {
+                index = TakeIndex();
+                creating = true;
+            }
+            lock.unlock();
+
+            for (Segment& segment : finishing) RetireSegment(segment);
+            Segment created;
+            bool failed = false;
+            if (needReady) {
+                try {
+                    created = CreateSegment(index);
+                } catch (const std::system_error&) {
+                    /* 写日志的线程会在 Rotate 中自己重试, 仍然失败时丢弃日志并计数 */
+                    failed = true;
+                }
+            }
+
+            lock.lock();
+            if (needReady) {
+                creating = false;
+                if (failed) {
+                    preallocFailed = true;
+                    ReleaseIndex(index);
+                } else {
+                    ready = created;
+                }
+                readyCv.notify_all();
+            }
+        }
+    }
+
+private:
+    std::string basePath;
+    MappedFileSinkOptions options;
+
+    Segment current;                /* 只由写入线程使用 */
+    size_t stalls { 0 };
+    size_t droppedBytes { 0 };
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::condition_variable readyCv;
+    Segment ready;                  /* 后台线程预分配好的下一个段 */
+    std::deque<Segment> retired;    /* 写满等待收尾的段 */
+    size_t nextIndex { 0 };
+    size_t spareIndex { 0 };
+    bool hasSpareIndex { false };
+    bool creating { false };         /* 有线程 (后台线程或写入线程) 正在创建段 */
+    bool preallocFailed { false };
+    bool stopping { false };
+    std::thread worker;
+};
+}
+
+#endif
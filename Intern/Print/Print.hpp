@@ -2,15 +2,88 @@
 
 #include <string>
 
+#include "AsyncLogger.hpp"
+#include "BufferedLogger.hpp"
 #include "Printable.hpp"
+#include "RateLimit.hpp"
+#include "SmallBuffer.hpp"
 namespace Tools{
+namespace Detail{
+/* 以下是已经检查过级别的版本, 供 PRINT_XXX 宏使用, 避免重复读取运行期级别 */
+template <typename... Args>
+void PrintEnabled(std::ostream& stream, [[maybe_unused]] Level level, const Args&... args)
+{
+    SmallBuffer<> line;
+    (Detail::AppendArg(line, args), ...);
+    line.push_back('\n');
+    stream.write(line.data(), static_cast<std::streamsize>(line.size()));
+    stream.flush();
+}
+
+template <typename... Args>
+void PrintEnabled(AsyncLogger& logger, Level level, const Args&... args)
+{
+    logger.Log(level, args...);
+}
+
+template <typename... Args>
+void PrintEnabled(BufferedLogger& logger, Level level, const Args&... args)
+{
+    logger.Log(level, args...);
+}
+}
+
+/*
+ * @function: 同步版本, 在栈上的缓冲中格式化整行后一次写入 stream 并 flush
+ * @note: 输出与 stream << args... << std::endl 一致, 但不经过 stream 的格式化与 locale, 短行不分配内存
+ */
 template <typename... Args>
 void Print(std::ostream& stream, Level level, const Args&... args)
 {
-    Printable p;
-    std::thread::id threadId = std::this_thread::get_id();
-    const time_point<system_clock> now = std::chrono::system_clock::now();
+    if (!IsLevelEnabled(level)) return ;
+    Detail::PrintEnabled(stream, level, args...);
+}
 
-    (stream << ... << args) << std::endl;
+/*
+ * @function: 异步版本, 调用线程只格式化并入队, 写入和 flush 在 logger 的后台线程上批量完成
+ */
+template <typename... Args>
+void Print(AsyncLogger& logger, Level level, const Args&... args)
+{
+    if (!IsLevelEnabled(level)) return ;
+    Detail::PrintEnabled(logger, level, args...);
+}
+
+/*
+ * @function: 每线程缓冲版本, 调用线程格式化后追加到自己的缓冲, 由 flusher 线程合并写出
+ */
+template <typename... Args>
+void Print(BufferedLogger& logger, Level level, const Args&... args)
+{
+    if (!IsLevelEnabled(level)) return ;
+    Detail::PrintEnabled(logger, level, args...);
+}
+
+/*
+ * @function: 格式串风格, 参数的原始字节入队, 在 logger 的后台线程上格式化
+ * @param: format 必须是字符串字面量 (队列里只保存地址), 格式串与参数不匹配时编译失败
+ */
+template <typename... Args>
+void PrintFormat(AsyncLogger& logger, Level level, Detail::FormatLiteral<Args...> format, const Args&... args)
+{
+    if (!IsLevelEnabled(level)) return ;
+    logger.LogFormat(level, format, args...);
+}
+
+/*
+ * @function: 级别作为模板参数, 编译期被裁掉的级别不会生成任何代码
+ * @note: 参数在调用前已经求值, 需要连参数都不求值时使用 LogLevel.hpp 中的 PRINT_XXX 宏
+ */
+template <Level level, typename Target, typename... Args>
+void Print(Target& target, const Args&... args)
+{
+    if constexpr (IsLevelCompiledIn(level)) {
+        Print(target, level, args...);
+    }
 }
 }
@@ -1,16 +1,33 @@
 #pragma once
+#include <atomic>
 #include <chrono>
+#include <cmath>
+#include <charconv>
+#include <cstdint>
+#include <functional>
 #include <ostream>
+#include <streambuf>
+#include <string_view>
+#include <optional>
+#include <sstream>
 #include <utility>
 #include <tuple>
 #include <any>
 #include <string>
+#include <variant>
 #include <type_traits>
-#include "../Base/TypeTraits.hpp"
+#include "../Base/Traits/TypeTraits.hpp"
 #if defined(__cpp_lib_format)
   #include <format>
 #endif
 #include "../Base/Proj.hpp"
+
+/* 只用于识别类型, 不引入 Optional.hpp 的依赖 */
+namespace BaseLib{
+template <typename Ty>
+class Optional;
+}
+
 namespace Tools{
 using namespace std::chrono;
 /*
@@ -68,28 +85,177 @@ INLINE std::string GetTimeToString(
 
 
 #if defined (__cpp_if_constexpr)
-/* 
- * @function: 打印单个值
- * @Supported types: 
- * @   BaseType: int, float, double, std::string, bool, const char*, enum
- * @   AdvancedType: std::optional, std::variant, std::any
+namespace Detail{
+template <typename Ty>
+inline constexpr bool kIsStringLike = std::is_same_v<Ty, std::string> || std::is_same_v<Ty, std::string_view> ||
+                                      std::is_same_v<Ty, const char*> || std::is_same_v<Ty, char*>;
+
+template <typename Ty>
+inline constexpr bool kIsCharArray = std::is_array_v<Ty> &&
+                                     std::is_same_v<std::remove_cv_t<std::remove_extent_t<Ty>>, char>;
+
+/* TypeTraits.hpp 中的 is_ostreamable 对不能输出的类型会直接编译失败, 这里用 requires 判断 */
+template <typename Ty>
+inline constexpr bool kIsOstreamable = requires (std::ostream& stream, const Ty& value){ stream << value; };
+
+/* 把 operator<< 的输出直接追加到 Buffer, 用于没有专门格式化的自定义类型 */
+template <typename Buffer>
+class BufferStreambuf final : public std::streambuf{
+public:
+    explicit BufferStreambuf(Buffer& out) : out(out) {}
+
+protected:
+    int_type overflow(int_type ch) override{
+        if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+            out.push_back(traits_type::to_char_type(ch));
+        }
+        return traits_type::not_eof(ch);
+    }
+    std::streamsize xsputn(const char* data, std::streamsize count) override{
+        out.append(data, static_cast<size_t>(count));
+        return count;
+    }
+
+private:
+    Buffer& out;
+};
+
+/*
+ * AppendTo 与 AppendArg 共用的实现, 复合类型的元素递归时沿用同一种风格
+ * kStreamStyle 为 true 时 (AppendArg) 标量与 std::ostream 的默认格式一致: bool 为 1/0, 浮点数相当于 %g,
+ * signed char / unsigned char 输出字符; 为 false 时 (AppendTo) 见 AppendTo 的说明
  */
-template <typename ValTy>
-INLINE std::string ValToString(const ValTy& val){
+template <bool kStreamStyle, typename Buffer, typename ValTy>
+void AppendValue(Buffer& out, const ValTy& val){
     using TargetType = std::remove_cvref_t<ValTy>;
-    /* number */
-    if constexpr (std::is_arithmetic_v<TargetType>){
-        return std::to_string(val);
-    /* std::string */
-    } else if constexpr (std::is_same_v<std::string, TargetType>){
-        return val;
-    /* const char* */
-    } else if constexpr (std::is_same_v<char*, TargetType>){
-        return std::string(val);
+    if constexpr (std::is_same_v<TargetType, bool>) {
+        if constexpr (kStreamStyle) {
+            out.push_back(val ? '1' : '0');
+        } else {
+            if (val) out.append("true", 4);
+            else out.append("false", 5);
+        }
+    } else if constexpr (std::is_same_v<TargetType, char> ||
+                         (kStreamStyle && (std::is_same_v<TargetType, signed char> || std::is_same_v<TargetType, unsigned char>))) {
+        out.push_back(static_cast<char>(val));
+    } else if constexpr (kStreamStyle && std::is_floating_point_v<TargetType>) {
+        /* 相当于 %g, 与 std::ostream 的默认精度 6 一致 */
+        char buffer[64];
+        const std::to_chars_result result = std::to_chars(buffer, buffer + sizeof(buffer), val, std::chars_format::general, 6);
+        out.append(buffer, static_cast<size_t>(result.ptr - buffer));
+    } else if constexpr (std::is_arithmetic_v<TargetType>) {
+        char buffer[64];
+        const std::to_chars_result result = std::to_chars(buffer, buffer + sizeof(buffer), val);
+        out.append(buffer, static_cast<size_t>(result.ptr - buffer));
+    } else if constexpr (std::is_enum_v<TargetType>) {
+        AppendValue<kStreamStyle>(out, static_cast<std::underlying_type_t<TargetType>>(val));
+    } else if constexpr (std::is_same_v<TargetType, std::string> || std::is_same_v<TargetType, std::string_view>) {
+        out.append(val.data(), val.size());
+    } else if constexpr (Detail::kIsCharArray<TargetType>) {
+        out.append(val, std::char_traits<char>::length(val));
+    } else if constexpr (std::is_same_v<TargetType, const char*> || std::is_same_v<TargetType, char*>) {
+        if (val) out.append(val, std::char_traits<char>::length(val));
+        else out.append("nullptr", 7);
+    } else if constexpr (std::is_same_v<TargetType, std::nullptr_t> || std::is_same_v<TargetType, std::nullopt_t>) {
+        if constexpr (std::is_same_v<TargetType, std::nullptr_t>) out.append("nullptr", 7);
+        else out.append("nullopt", 7);
+    } else if constexpr (std::is_pointer_v<TargetType>) {
+        char buffer[2 + sizeof(void*) * 2];
+        buffer[0] = '0';
+        buffer[1] = 'x';
+        const std::to_chars_result result = std::to_chars(buffer + 2, buffer + sizeof(buffer),
+                                                          reinterpret_cast<uintptr_t>(val), 16);
+        out.append(buffer, static_cast<size_t>(result.ptr - buffer));
+    } else if constexpr (IsSpecializationOf<TargetType, std::optional>::value ||
+                         IsSpecializationOf<TargetType, BaseLib::Optional>::value) {
+        if (val) AppendValue<kStreamStyle>(out, *val);
+        else out.append("nullopt", 7);
+    } else if constexpr (IsSpecializationOf<TargetType, std::pair>::value) {
+        out.push_back('(');
+        AppendValue<kStreamStyle>(out, val.first);
+        out.append(", ", 2);
+        AppendValue<kStreamStyle>(out, val.second);
+        out.push_back(')');
+    } else if constexpr (IsSpecializationOf<TargetType, std::tuple>::value) {
+        out.push_back('(');
+        std::apply([&out](const auto&... items){
+            bool first = true;
+            ((first ? void(first = false) : void(out.append(", ", 2)), AppendValue<kStreamStyle>(out, items)), ...);
+        }, val);
+        out.push_back(')');
+    } else if constexpr (IsSpecializationOf<TargetType, std::variant>::value) {
+        if (val.valueless_by_exception()) {
+            out.append("valueless", 9);
+        } else {
+            std::visit([&out](const auto& item){ AppendValue<kStreamStyle>(out, item); }, val);
+        }
+    } else if constexpr (IsSpecializationOf<TargetType, std::atomic>::value) {
+        AppendValue<kStreamStyle>(out, val.load(std::memory_order_relaxed));
+    } else if constexpr (std::is_same_v<TargetType, std::any>) {
+        out.append("any(", 4);
+        if (val.has_value()) {
+            const char* name = val.type().name();
+            out.append(name, std::char_traits<char>::length(name));
+        }
+        out.push_back(')');
+    } else if constexpr (Detail::kIsOstreamable<TargetType> && !std::is_array_v<TargetType>) {
+        Detail::BufferStreambuf<Buffer> buf(out);
+        std::ostream stream(&buf);
+        stream << val;
+    } else if constexpr (is_range<const TargetType>::value) {
+        out.push_back('[');
+        bool first = true;
+        for (const auto& item : val) {
+            if (!first) out.append(", ", 2);
+            first = false;
+            AppendValue<kStreamStyle>(out, item);
+        }
+        out.push_back(']');
     } else {
-        return "";
+        static_assert(sizeof(TargetType) == 0, "AppendTo: unsupported type");
     }
 }
+}
+
+/*
+ * @function: 把 value 的文本追加到 out 末尾, 不产生临时 std::string
+ * @param: out 任何提供 append(const char*, size_t) 与 push_back(char) 的缓冲, 例如 std::string
+ * @      清空后重复使用同一个缓冲 (clear 不释放容量) 时整个过程不分配内存
+ * @Supported types:
+ * @   算术类型: 整数与浮点数使用 std::to_chars (浮点数为最短的可还原表示), bool 输出 true/false, char 原样输出
+ * @   字符串: std::string, std::string_view, const char* (nullptr 输出 "nullptr"), 字符数组
+ * @   enum: 底层整数; 指针: 十六进制地址
+ * @   std::optional / BaseLib::Optional: 值或 "nullopt"
+ * @   std::pair / std::tuple: "(a, b)"; std::variant: 当前的值; std::atomic: relaxed 读出的值
+ * @   可以 operator<< 的其他类型: 通过一个追加到 out 的 streambuf 输出 (优先于范围, 例如 std::filesystem::path)
+ * @   范围: "[a, b, c]", 元素递归格式化 (std::map 的元素是 pair, 输出 "[(k, v), ...]")
+ */
+template <typename Buffer, typename ValTy>
+void AppendTo(Buffer& out, const ValTy& val){
+    Detail::AppendValue<false>(out, val);
+}
+
+/* 把范围的元素用 separator 连接后追加到 out, 不加括号 */
+template <typename Buffer, typename Range>
+void AppendRange(Buffer& out, const Range& range, std::string_view separator = ", "){
+    bool first = true;
+    for (const auto& item : range) {
+        if (!first) out.append(separator.data(), separator.size());
+        first = false;
+        AppendTo(out, item);
+    }
+}
+
+/*
+ * @function: 打印单个值, 返回新的 std::string; 在循环中请直接使用 AppendTo 复用缓冲
+ * @Supported types: 见 AppendTo
+ */
+template <typename ValTy>
+INLINE std::string ValToString(const ValTy& val){
+    std::string res;
+    AppendTo(res, val);
+    return res;
+}
 
 /* 
  * @function: 将一个指针类型的range转换为字符串
@@ -121,62 +287,52 @@ INLINE std::string PtrToString(PointTy* ptr){
 
 /*
  * @function: 将一个范围转换为字符串
- * @return: "val1, val2, val3, ... "
+ * @return: "val1, val2, val3"
  */
 template <typename Range>
 INLINE std::string RangeToString(const Range& range){
-    if constexpr (has_iterator<Range>::value){
-        std::string res = "";
-        for (const auto& item : range) {
-            if constexpr (std::is_scalar<decltype(item)>::value) {
-                res += ValToString(item) + ", ";
-            } else if constexpr (is_ostreamable<decltype(item)>::value){
-                std::ostringstream ss;
-                ss << item;
-                res += ss.str() + ", ";
-            }
-        }
-        // 移除最后 ", "
-        res.pop_back(); 
-        res.pop_back(); 
-        return res;
-    }
-    return "";
+    std::string res;
+    AppendRange(res, range);
+    return res;
 }
 
 template <typename Ty>
 INLINE std::string RangeToString(const Ty* arr, size_t size){
-
+    std::string res;
+    for (size_t i = 0; i < size; ++i) {
+        if (i != 0) res.append(", ", 2);
+        AppendTo(res, arr[i]);
+    }
+    return res;
 }
 
 template <typename Ty>
 INLINE std::string OptionToString(const std::optional<Ty>& opt){
-
+    return ValToString(opt);
 }
 
-template <typename Ty>
 INLINE std::string AnyToString(const std::any& val){
-
+    return ValToString(val);
 }
 
-template <typename Ty>
-INLINE std::string VariantToString(const std::variant<Ty>& var){
-
+template <typename... Types>
+INLINE std::string VariantToString(const std::variant<Types...>& var){
+    return ValToString(var);
 }
 
 template <typename... Args>
 INLINE std::string TupleToString(const std::tuple<Args...>& dict){
-
+    return ValToString(dict);
 }
 
 template <typename First, typename Second>
 INLINE std::string PairToString(const std::pair<First, Second>& p){
-
+    return ValToString(p);
 }
 
 template <typename Ty>
 INLINE std::string AtomicToString(const std::atomic<Ty>& val){
-
+    return ValToString(val);
 }
 
 #else // 没有 if constexpr 这个语法
@@ -1,18 +1,19 @@
+#pragma once
+
 #include <chrono>
 #include <optional>
 #include <thread>
 #include <ostream>
 #include <string>
-#include <sstream>
 #include <functional>
+#include "DeferredFormat.hpp"
+#include "LogLevel.hpp"
 #include "PrintTools.hpp"
+#include "SmallBuffer.hpp"
+#include "Timestamp.hpp"
 
 namespace Tools{
 using namespace std::chrono;
-enum class Level{
-    Normal, Warning, Error
-};
-
 class Printable{
 public:
     Printable() = default;
@@ -23,22 +24,41 @@ public:
         }
     ~Printable() = default;
     
+    /* 在栈上的缓冲中格式化后一次写入 stream, 短行不分配内存 */
     template <typename... Args>
     void operator()(std::ostream& stream, const Args&... args) const{
         if (!Check()) return ;
-        stream << Message(args...);
+        SmallBuffer<> line;
+        FormatTo(line, args...);
+        stream.write(line.data(), static_cast<std::streamsize>(line.size()));
     }
 
     template <typename... Args>
     std::string Message(const Args&... args) const{
-        std::ostringstream oss;
+        std::string message;
+        FormatTo(message, args...);
+        return message;
+    }
+
+    /*
+     * @function: 把 "[thread id: ...] [call time: ...] " 前缀和参数追加到 out
+     * @param: out SmallBuffer, std::string 或其他 AppendTo 支持的缓冲
+     */
+    template <typename Buffer, typename... Args>
+    void FormatTo(Buffer& out, const Args&... args) const{
         if (threadId) {
-            oss << "[thread id: " << std::hash<std::thread::id>{}(*threadId) << "] ";
+            out.append("[thread id: ", 12);
+            AppendTo(out, std::hash<std::thread::id>{}(*threadId));
+            out.append("] ", 2);
         }
         if (time) {
-            oss << "[call time: " << GetTimeToString("{}-{}-{},{}-{}-{}" , *time) << "] ";
+            /* 同一秒内只补小数部分, 见 Timestamp.hpp */
+            char stamp[kTimestampMaxLength];
+            out.append("[call time: ", 12);
+            out.append(stamp, FormatTimestamp(stamp, *time));
+            out.append("] ", 2);
         }
-        return oss.str();
+        (Detail::AppendArg(out, args), ...);
     }
 public:
     bool Check() const noexcept {
@@ -0,0 +1,159 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <source_location>
+
+#include "LogLevel.hpp"
+
+namespace Tools{
+/* 一次检查的结果; suppressed 为上一条输出之后被丢弃的条数 */
+struct LogAdmission{
+    bool allowed { false };
+    uint64_t suppressed { 0 };
+
+    explicit operator bool() const noexcept{
+        return allowed;
+    }
+};
+
+/*
+ * @function: 单个调用点的采样 / 限流状态
+ * @note: 由 PRINT_EVERY_N / PRINT_FIRST_N_THEN_EVERY / PRINT_RATE_LIMITED 宏在调用点定义为 constinit 的 static,
+ * @      没有静态初始化的 guard, 每次检查只有一次 relaxed 原子操作
+ * @note: EveryN / FirstNThenEvery 的丢弃数由计数器直接算出, 不需要额外的原子变量;
+ * @      RateLimit 是以 GCRA 实现的令牌桶 (一个原子的 "理论到达时间"), 丢弃时额外累加一次丢弃计数
+ * @note: location 默认是构造处, 即宏展开的位置, 可用于区分调用点
+ */
+class LogLimiter{
+public:
+    enum class Mode : uint8_t{
+        EveryN, FirstNThenEvery, RateLimit
+    };
+
+    /* 每 n 条输出 1 条 (第 1, n+1, 2n+1, ... 条) */
+    static constexpr LogLimiter EveryN(uint64_t n, std::source_location location = std::source_location::current()) noexcept{
+        return LogLimiter(Mode::EveryN, 0, n == 0 ? 1 : n, 0, location);
+    }
+
+    /* 前 k 条全部输出, 之后每 n 条输出 1 条 */
+    static constexpr LogLimiter FirstNThenEvery(uint64_t k, uint64_t n, std::source_location location = std::source_location::current()) noexcept{
+        return LogLimiter(Mode::FirstNThenEvery, k, n == 0 ? 1 : n, 0, location);
+    }
+
+    /* 平均每秒最多 perSecond 条, 允许一次突发 burst 条 */
+    static constexpr LogLimiter RateLimit(double perSecond, uint64_t burst = 1, std::source_location location = std::source_location::current()) noexcept{
+        const int64_t interval = perSecond > 0.0 ? static_cast<int64_t>(1e9 / perSecond) : INT64_MAX / 4;
+        const int64_t tolerance = interval * static_cast<int64_t>(burst == 0 ? 0 : burst - 1);
+        return LogLimiter(Mode::RateLimit, 0, static_cast<uint64_t>(interval), static_cast<uint64_t>(tolerance), location);
+    }
+
+    LogLimiter(const LogLimiter&) = delete;
+    LogLimiter& operator=(const LogLimiter&) = delete;
+
+    /* 这一条是否输出 */
+    LogAdmission Check() noexcept{
+        switch (mode) {
+        case Mode::EveryN: {
+            const uint64_t count = state.fetch_add(1, std::memory_order_relaxed);
+            if (count % period != 0) return {};
+            return { true, count == 0 ? 0 : period - 1 };
+        }
+        case Mode::FirstNThenEvery: {
+            const uint64_t count = state.fetch_add(1, std::memory_order_relaxed);
+            if (count < first) return { true, 0 };
+            if ((count - first) % period != 0) return {};
+            return { true, count == first ? 0 : period - 1 };
+        }
+        case Mode::RateLimit:
+            return CheckRate();
+        }
+        return {};
+    }
+
+    Mode GetMode() const noexcept{
+        return mode;
+    }
+    const std::source_location& Location() const noexcept{
+        return location;
+    }
+
+private:
+    constexpr LogLimiter(Mode mode, uint64_t first, uint64_t period, uint64_t tolerance, std::source_location location) noexcept
+        : mode(mode), first(first), period(period), tolerance(tolerance), location(location) {}
+
+    static int64_t NowNs() noexcept{
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    /*
+     * GCRA: state 是下一条 "理论上" 可以输出的时间 (tat)
+     * 当前时间 now 满足 max(tat, now) - now <= tolerance 时输出, 并把 tat 推后一个间隔
+     */
+    LogAdmission CheckRate() noexcept{
+        const int64_t now = NowNs();
+        uint64_t tat = state.load(std::memory_order_relaxed);
+        for (;;) {
+            const int64_t base = static_cast<int64_t>(tat) > now ? static_cast<int64_t>(tat) : now;
+            if (base - now > static_cast<int64_t>(tolerance)) {
+                dropped.fetch_add(1, std::memory_order_relaxed);
+                return {};
+            }
+            if (state.compare_exchange_weak(tat, static_cast<uint64_t>(base + static_cast<int64_t>(period)),
+                                            std::memory_order_relaxed)) {
+                break;
+            }
+        }
+        if (dropped.load(std::memory_order_relaxed) == 0) return { true, 0 };
+        return { true, dropped.exchange(0, std::memory_order_relaxed) };
+    }
+
+private:
+    Mode mode;
+    uint64_t first { 0 };
+    uint64_t period { 1 };              /* EveryN / FirstNThenEvery 的 n; RateLimit 的间隔 (ns) */
+    uint64_t tolerance { 0 };           /* RateLimit 允许提前的时间 (ns), 即 (burst - 1) 个间隔 */
+    std::source_location location;
+    std::atomic<uint64_t> state { 0 };  /* 计数器或 tat */
+    std::atomic<uint64_t> dropped { 0 };
+};
+}
+
+/*
+ * @function: 带采样 / 限流的 Print, 每个调用点独立计数
+ * @note: 级别检查在前, 被关闭的级别不消耗计数; 被丢弃的调用不会求值参数
+ * @note: n / k / perSecond / burst 必须是常量表达式 (调用点的状态是 constinit 的 static)
+ * @note: 有丢弃时, 下一条输出的末尾追加 " [suppressed N]"
+ * @Usage:
+    for (auto& packet : packets) {
+        if (!packet.Valid()) {
+            PRINT_RATE_LIMITED(Tools::Level::Warning, logger, 10, 5, "bad packet from ", packet.Source());   // 每秒最多 10 条, 突发 5 条
+        }
+        PRINT_EVERY_N(Tools::Level::Debug, logger, 1000, "processed ", packet.Id());
+        PRINT_FIRST_N_THEN_EVERY(Tools::Level::Normal, std::cout, 3, 100, "retrying ", packet.Id());
+    }
+ */
+#define TOOLS_PRINT_LIMITED_(limiterInit, level, target, ...)                                  \
+    do {                                                                                       \
+        const ::Tools::Level toolsLevel_ = (level);                                            \
+        if (::Tools::IsLevelEnabled(toolsLevel_)) {                                            \
+            static constinit ::Tools::LogLimiter toolsLimiter_ = limiterInit;                  \
+            if (const ::Tools::LogAdmission toolsAdmission_ = toolsLimiter_.Check()) {         \
+                if (toolsAdmission_.suppressed == 0) {                                         \
+                    ::Tools::Detail::PrintEnabled(target, toolsLevel_, __VA_ARGS__);           \
+                } else {                                                                       \
+                    ::Tools::Detail::PrintEnabled(target, toolsLevel_, __VA_ARGS__,            \
+                        " [suppressed ", toolsAdmission_.suppressed, "]");                     \
+                }                                                                              \
+            }                                                                                  \
+        }                                                                                      \
+    } while (0)
+
+#define PRINT_EVERY_N(level, target, n, ...) \
+    TOOLS_PRINT_LIMITED_(::Tools::LogLimiter::EveryN(n), level, target, __VA_ARGS__)
+#define PRINT_FIRST_N_THEN_EVERY(level, target, k, n, ...) \
+    TOOLS_PRINT_LIMITED_(::Tools::LogLimiter::FirstNThenEvery(k, n), level, target, __VA_ARGS__)
+#define PRINT_RATE_LIMITED(level, target, perSecond, burst, ...) \
+    TOOLS_PRINT_LIMITED_(::Tools::LogLimiter::RateLimit(perSecond, burst), level, target, __VA_ARGS__)
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <iterator>
+#include <string>
+#include <string_view>
+
+namespace Tools{
+/*
+ * @function: 先用栈上数组, 放不下时才转到堆上的格式化缓冲
+ * @note: 接口与 std::string 的追加部分一致 (append / push_back / data / size / clear), 可以直接作为 AppendTo 的目标
+ * @note: Out() 返回 std::back_insert_iterator, 可以传给 std::format_to
+ * @note: 不可拷贝, 只用作函数内的临时缓冲; clear() 之后继续使用已经分配的堆空间
+ * @Usage:
+    Tools::SmallBuffer<> line;
+    Tools::AppendTo(line, "frame ");
+    Tools::AppendTo(line, frameIndex);
+    std::format_to(line.Out(), " took {} ms", ms);     // 有 <format> 时
+    stream.write(line.data(), line.size());
+ */
+template <size_t N = 256>
+class SmallBuffer{
+public:
+    using value_type = char;
+    using iterator = char*;
+    using const_iterator = const char*;
+
+    static constexpr size_t kInlineCapacity = N;
+
+    SmallBuffer() noexcept = default;
+    SmallBuffer(const SmallBuffer&) = delete;
+    SmallBuffer& operator=(const SmallBuffer&) = delete;
+
+    ~SmallBuffer(){
+        if (buffer != inlineBuffer) delete[] buffer;
+    }
+
+    void append(const char* data, size_t count){
+        if (count > allocated - length) Grow(length + count);
+        std::memcpy(buffer + length, data, count);
+        length += count;
+    }
+    void append(std::string_view text){
+        append(text.data(), text.size());
+    }
+    void push_back(char ch){
+        if (length == allocated) Grow(length + 1);
+        buffer[length++] = ch;
+    }
+    void reserve(size_t count){
+        if (count > allocated) Grow(count);
+    }
+    /* 只重置长度, 保留已分配的空间 */
+    void clear() noexcept{
+        length = 0;
+    }
+
+    char* data() noexcept { return buffer; }
+    const char* data() const noexcept { return buffer; }
+    size_t size() const noexcept { return length; }
+    size_t capacity() const noexcept { return allocated; }
+    bool empty() const noexcept { return length == 0; }
+    char* begin() noexcept { return buffer; }
+    char* end() noexcept { return buffer + length; }
+    const char* begin() const noexcept { return buffer; }
+    const char* end() const noexcept { return buffer + length; }
+
+    std::string_view View() const noexcept{
+        return std::string_view(buffer, length);
+    }
+    std::string ToString() const{
+        return std::string(buffer, length);
+    }
+    /* 是否已经转到堆上 */
+    bool IsSpilled() const noexcept{
+        return buffer != inlineBuffer;
+    }
+    /* std::format_to / std::copy 的输出迭代器 */
+    std::back_insert_iterator<SmallBuffer> Out() noexcept{
+        return std::back_insert_iterator<SmallBuffer>(*this);
+    }
+
+private:
+    void Grow(size_t required){
+        size_t next = allocated * 2;
+        if (next < required) next = required;
+        char* grown = new char[next];
+        std::memcpy(grown, buffer, length);
+        if (buffer != inlineBuffer) delete[] buffer;
+        buffer = grown;
+        allocated = next;
+    }
+
+private:
+    char inlineBuffer[N];
+    char* buffer { inlineBuffer };
+    size_t length { 0 };
+    size_t allocated { N };
+};
+}
@@ -0,0 +1,226 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <thread>
+
+#if defined(__x86_64__) || defined(__i386__)
+  #include <cpuid.h>
+  #include <x86intrin.h>
+  #define TOOLS_HAS_TSC 1
+#elif defined(_M_X64) || defined(_M_IX86)
+  #include <intrin.h>
+  #define TOOLS_HAS_TSC 1
+#endif
+
+namespace Tools{
+/*
+ * @function: 用于日志时间戳的廉价墙上时钟
+ * @note: x86 上如果 TSC 是 invariant 的, Now() 只读一次 rdtsc, 再按校准出的频率换算成 system_clock 时间
+ * @note: 每个线程每隔约 1 秒用 system_clock 重新对齐一次, 避免与系统时间漂移; 其他平台直接使用 system_clock
+ * @note: 第一次调用会花约 10ms 校准 TSC 频率, 可以在启动时调用 WallClock::Calibrate() 提前完成
+ */
+class WallClock{
+public:
+    using time_point = std::chrono::time_point<std::chrono::system_clock, std::chrono::nanoseconds>;
+
+    static time_point Now() noexcept{
+#if defined(TOOLS_HAS_TSC)
+        const Calibration& calibration = Calibrate();
+        if (calibration.usable) [[likely]] {
+            thread_local Anchor anchor;
+            const uint64_t ticks = ReadTsc();
+            if (ticks - anchor.ticks > calibration.ticksPerResync) [[unlikely]] {
+                anchor.ticks = ReadTsc();
+                anchor.ns = SystemNs();
+                return time_point(std::chrono::nanoseconds(anchor.ns));
+            }
+            const int64_t elapsed = static_cast<int64_t>(static_cast<double>(ticks - anchor.ticks) * calibration.nsPerTick);
+            return time_point(std::chrono::nanoseconds(anchor.ns + elapsed));
+        }
+#endif
+        return time_point(std::chrono::nanoseconds(SystemNs()));
+    }
+
+    /* 是否真正使用了 TSC */
+    static bool UsesTsc() noexcept{
+#if defined(TOOLS_HAS_TSC)
+        return Calibrate().usable;
+#else
+        return false;
+#endif
+    }
+
+#if defined(TOOLS_HAS_TSC)
+    struct Calibration{
+        bool usable { false };
+        double nsPerTick { 0.0 };
+        uint64_t ticksPerResync { 0 };
+    };
+
+    static const Calibration& Calibrate() noexcept{
+        static const Calibration calibration = Measure();
+        return calibration;
+    }
+#else
+    static void Calibrate() noexcept {}
+#endif
+
+private:
+    static int64_t SystemNs() noexcept{
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+    }
+
+#if defined(TOOLS_HAS_TSC)
+    struct Anchor{
+        uint64_t ticks { 0 };
+        int64_t ns { 0 };
+    };
+
+    static uint64_t ReadTsc() noexcept{
+        return __rdtsc();
+    }
+
+    static bool HasInvariantTsc() noexcept{
+#if defined(_MSC_VER)
+        int info[4];
+        __cpuid(info, 0x80000000);
+        if (static_cast<unsigned>(info[0]) < 0x80000007u) return false;
+        __cpuid(info, 0x80000007);
+        return (info[3] & (1 << 8)) != 0;
+#else
+        unsigned eax, ebx, ecx, edx;
+        if (!__get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx)) return false;
+        return (edx & (1u << 8)) != 0;
+#endif
+    }
+
+    static Calibration Measure() noexcept{
+        Calibration result;
+        if (!HasInvariantTsc()) return result;
+        using Steady = std::chrono::steady_clock;
+        const auto begin = Steady::now();
+        const uint64_t beginTicks = ReadTsc();
+        while (Steady::now() - begin < std::chrono::milliseconds(10)) {
+            std::this_thread::yield();
+        }
+        const uint64_t endTicks = ReadTsc();
+        const auto end = Steady::now();
+        const double ns = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count());
+        if (endTicks <= beginTicks || ns <= 0.0) return result;
+        result.nsPerTick = ns / static_cast<double>(endTicks - beginTicks);
+        result.ticksPerResync = static_cast<uint64_t>(1e9 / result.nsPerTick);
+        result.usable = true;
+        return result;
+    }
+#endif
+};
+
+namespace Detail{
+/* 每个线程缓存当前这一秒的 "年-月-日,时-分-秒" 前缀 */
+struct TimestampCache{
+    int64_t second { INT64_MIN };
+    char prefix[32] {};
+    size_t length { 0 };
+};
+
+inline void Put2(char* out, unsigned value) noexcept{
+    out[0] = static_cast<char>('0' + value / 10);
+    out[1] = static_cast<char>('0' + value % 10);
+}
+
+inline void FillPrefix(TimestampCache& cache, int64_t second) noexcept{
+    using namespace std::chrono;
+    const sys_seconds time{ seconds(second) };
+    const auto day = floor<days>(time);
+    const year_month_day ymd{ day };
+    const hh_mm_ss<seconds> hms{ time - day };
+
+    char* out = cache.prefix;
+    int year = int(ymd.year());
+    if (year < 0) {
+        *out++ = '-';
+        year = -year;
+    }
+    char digits[8];
+    int count = 0;
+    do {
+        digits[count++] = static_cast<char>('0' + year % 10);
+        year /= 10;
+    } while (year > 0);
+    while (count < 4) digits[count++] = '0';
+    while (count > 0) *out++ = digits[--count];
+    *out++ = '-';
+    Put2(out, unsigned(ymd.month()));
+    out += 2;
+    *out++ = '-';
+    Put2(out, unsigned(ymd.day()));
+    out += 2;
+    *out++ = ',';
+    Put2(out, static_cast<unsigned>(hms.hours().count()));
+    out += 2;
+    *out++ = '-';
+    Put2(out, static_cast<unsigned>(hms.minutes().count()));
+    out += 2;
+    *out++ = '-';
+    Put2(out, static_cast<unsigned>(hms.seconds().count()));
+    out += 2;
+    cache.length = static_cast<size_t>(out - cache.prefix);
+    cache.second = second;
+}
+}
+
+/*
+ * @function: 把时间点格式化为 "YYYY-MM-DD,HH-MM-SS.ffff" (UTC), 写入 out 并返回长度
+ * @param: out 至少 kTimestampMaxLength 字节
+ * @param: accuracy 秒的小数位数, 0 ~ 9
+ * @note: 同一秒内的调用只拷贝缓存的前缀并补上小数部分, 不做日期计算也不分配内存
+ */
+inline constexpr size_t kTimestampMaxLength = 48;
+
+template <typename Duration>
+size_t FormatTimestamp(char* out, std::chrono::time_point<std::chrono::system_clock, Duration> time, int accuracy = 4) noexcept{
+    using namespace std::chrono;
+    const int64_t ns = duration_cast<nanoseconds>(time.time_since_epoch()).count();
+    int64_t second = ns / 1000000000;
+    int64_t fraction = ns % 1000000000;
+    if (fraction < 0) {
+        fraction += 1000000000;
+        --second;
+    }
+
+    thread_local Detail::TimestampCache cache;
+    if (cache.second != second) [[unlikely]] {
+        Detail::FillPrefix(cache, second);
+    }
+    std::memcpy(out, cache.prefix, cache.length);
+    size_t length = cache.length;
+
+    if (accuracy > 9) accuracy = 9;
+    if (accuracy > 0) {
+        out[length++] = '.';
+        char digits[9];
+        for (int i = 8; i >= 0; --i) {
+            digits[i] = static_cast<char>('0' + fraction % 10);
+            fraction /= 10;
+        }
+        std::memcpy(out + length, digits, static_cast<size_t>(accuracy));
+        length += static_cast<size_t>(accuracy);
+    }
+    return length;
+}
+
+template <typename Duration>
+void AppendTimestamp(std::string& out, std::chrono::time_point<std::chrono::system_clock, Duration> time, int accuracy = 4){
+    char buffer[kTimestampMaxLength];
+    out.append(buffer, FormatTimestamp(buffer, time, accuracy));
+}
+
+/* 当前时间, 使用 WallClock */
+inline void AppendTimestamp(std::string& out, int accuracy = 4){
+    AppendTimestamp(out, WallClock::Now(), accuracy);
+}
+}
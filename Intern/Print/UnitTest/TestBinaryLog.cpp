@@ -0,0 +1,105 @@
+#include "../BinaryLog.hpp"
+#include "../MappedFileSink.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+#if defined(__unix__) || defined(__APPLE__)
+  #include <unistd.h>
+#endif
+
+bool BinaryLogTest() {
+    bool all_passed = true;
+    std::cout << "Running BinaryLog Tests...\n";
+
+#if defined(TOOLS_HAS_POSIX_SINK)
+    // 1. BinaryLog -> MappedFileSink (4 KB 的小段, 记录跨段) -> 按序号拼接解码, 每条记录都能还原
+    {
+        std::cout << "Running BinaryLog Tests1\n";
+        namespace fs = std::filesystem;
+        const fs::path directory = fs::temp_directory_path() / ("binary_log_test_" + std::to_string(::getpid()));
+        fs::remove_all(directory);
+        fs::create_directories(directory);
+        const std::string basePath = (directory / "out.blog").string();
+
+        constexpr int64_t kRecords = 2000;
+        {
+            Tools::MappedFileSink sink(basePath, { .segmentBytes = 4096, .prefault = false });
+            Tools::BinaryLog log(sink);
+            static const Tools::BinaryCallsite site{};
+            for (int64_t i = 0; i < kRecords; ++i) {
+                /* 整数 10 的字节是 '\n', 段在任意字节处切换 */
+                while (!log.Log(Tools::Level::Normal, site, "value ", i, " ten ", 10, " half ", static_cast<double>(i) / 2)) {
+                    log.Flush();
+                }
+            }
+            log.Stop();
+        }
+
+        /* 按文件名的字典序传入 (out.blog.10 排在 out.blog.2 之前), 由 GroupBinaryLogStreams 排序 */
+        std::vector<std::string> paths;
+        for (const auto& entry : fs::directory_iterator(directory)) paths.push_back(entry.path().string());
+        std::sort(paths.begin(), paths.end());
+        const auto streams = Tools::GroupBinaryLogStreams(paths);
+        if (paths.size() < 10 || streams.size() != 1) {
+            std::cerr << paths.size() << " segments grouped into " << streams.size() << " streams\n";
+            all_passed = false;
+        }
+
+        std::string content;
+        for (const std::string& path : streams.empty() ? std::vector<std::string>{} : streams.front()) {
+            std::ifstream file(path, std::ios::binary);
+            content.append(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        }
+        Tools::BinaryLogReader reader(content);
+        Tools::BinaryRecordView record;
+        int64_t expected = 0;
+        size_t callsites = 0;
+        while (reader.Next(record) && all_passed) {
+            if (record.header.kind == Tools::BinaryRecordKind::Callsite) {
+                ++callsites;
+                continue;
+            }
+            std::vector<int64_t> integers;
+            const bool complete = Tools::DecodeBinaryFields(record, [&](const Tools::BinaryField& field){
+                if (field.type == Tools::BinaryFieldType::I64 || field.type == Tools::BinaryFieldType::I32) {
+                    integers.push_back(field.integer);
+                }
+            });
+            if (!complete || integers.size() != 2 || integers[0] != expected || integers[1] != 10) {
+                std::cerr << "record " << expected << " did not round-trip\n";
+                all_passed = false;
+            }
+            ++expected;
+        }
+        if (expected != kRecords || callsites != 1 || reader.GetOffset() != content.size()) {
+            std::cerr << "decoded " << expected << " records, " << callsites << " callsites, "
+                      << content.size() - reader.GetOffset() << " trailing bytes\n";
+            all_passed = false;
+        }
+        fs::remove_all(directory);
+    }
+#endif
+
+    // 2. 序号不连续的段和普通文件各自是一个流, 流按第一次出现的顺序排列
+    {
+        std::cout << "Running BinaryLog Tests2\n";
+        const auto grouped = Tools::GroupBinaryLogStreams({ "a.log", "b.blog.3", "b.blog.1", "b.blog.0", "c.blog.x" });
+        const std::vector<std::vector<std::string>> want = { { "a.log" }, { "b.blog.0", "b.blog.1" }, { "b.blog.3" }, { "c.blog.x" } };
+        if (grouped != want) {
+            std::cerr << "unexpected stream grouping\n";
+            all_passed = false;
+        }
+    }
+
+    if (all_passed) {
+        std::cout << "All BinaryLog tests passed!\n";
+    } else {
+        std::cout << "Some BinaryLog tests FAILED!\n";
+    }
+    return all_passed;
+}
@@ -0,0 +1,167 @@
+#include "../Print.hpp"
+#include "../SmallBuffer.hpp"
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <thread>
+#include <vector>
+#if defined(__cpp_lib_format)
+  #include <format>
+#endif
+
+/* 替换全局 operator new, 统计 counting 为 true 期间的分配次数 */
+namespace {
+std::atomic<bool> counting { false };
+std::atomic<size_t> allocations { 0 };
+}
+
+void* operator new(std::size_t size){
+    if (counting.load(std::memory_order_relaxed)) {
+        allocations.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (void* ptr = std::malloc(size ? size : 1)) return ptr;
+    throw std::bad_alloc();
+}
+void operator delete(void* ptr) noexcept{
+    std::free(ptr);
+}
+void operator delete(void* ptr, std::size_t) noexcept{
+    std::free(ptr);
+}
+
+namespace {
+/* 计算 fn 执行期间的堆分配次数 */
+template <typename Fn>
+size_t CountAllocations(Fn&& fn){
+    allocations.store(0, std::memory_order_relaxed);
+    counting.store(true, std::memory_order_relaxed);
+    fn();
+    counting.store(false, std::memory_order_relaxed);
+    return allocations.load(std::memory_order_relaxed);
+}
+
+/* 只记录写入内容的 streambuf, 自身不分配内存 */
+class FixedStreambuf : public std::streambuf{
+public:
+    FixedStreambuf(){
+        setp(storage, storage + sizeof(storage));
+    }
+    std::string_view View() const{
+        return std::string_view(pbase(), static_cast<size_t>(pptr() - pbase()));
+    }
+    void Reset(){
+        setp(storage, storage + sizeof(storage));
+    }
+private:
+    char storage[1024];
+};
+}
+
+bool SmallBufferTest() {
+    bool all_passed = true;
+    std::cout << "Running SmallBuffer Tests...\n";
+
+    // 1. 短行完全在栈上, 不分配
+    {
+        std::cout << "Running SmallBuffer Tests1\n";
+        size_t count = CountAllocations([]{
+            Tools::SmallBuffer<> line;
+            Tools::AppendTo(line, "frame ");
+            Tools::AppendTo(line, 42);
+            Tools::AppendTo(line, " took ");
+            Tools::AppendTo(line, 16.6);
+            if (line.View() != "frame 42 took 16.6" || line.IsSpilled()) {
+                std::cerr << "short line: " << line.View() << "\n";
+                std::abort();
+            }
+        });
+        if (count != 0) {
+            std::cerr << "short line allocated " << count << " times\n";
+            all_passed = false;
+        }
+    }
+
+    // 2. 超出栈上容量时转到堆上, 内容保持完整
+    {
+        std::cout << "Running SmallBuffer Tests2\n";
+        Tools::SmallBuffer<16> line;
+        std::string expected;
+        for (int i = 0; i < 100; ++i) {
+            Tools::AppendTo(line, i);
+            expected += std::to_string(i);
+        }
+        if (!line.IsSpilled() || line.View() != expected) {
+            std::cerr << "spill failed: " << line.View() << "\n";
+            all_passed = false;
+        }
+        /* clear 之后复用已经分配的空间 */
+        line.clear();
+        size_t count = CountAllocations([&]{
+            for (int i = 0; i < 100; ++i) Tools::AppendTo(line, i);
+        });
+        if (count != 0 || line.View() != expected) {
+            std::cerr << "reuse after clear allocated " << count << " times\n";
+            all_passed = false;
+        }
+    }
+
+    // 3. Printable 带线程 id 与时间前缀时也不分配
+    {
+        std::cout << "Running SmallBuffer Tests3\n";
+        Tools::Printable printable;
+        printable.SetThreadId(std::this_thread::get_id()).SetTime(std::chrono::system_clock::now());
+        Tools::SmallBuffer<> line;
+        printable.FormatTo(line, "warmup");     /* 第一次调用会初始化时间戳的线程缓存 */
+        line.clear();
+        size_t count = CountAllocations([&]{
+            printable.FormatTo(line, "loaded ", 128, " assets in ", 3.5, " ms");
+        });
+        if (count != 0 || line.View().find("loaded 128 assets in 3.5 ms") == std::string_view::npos) {
+            std::cerr << "Printable allocated " << count << " times: " << line.View() << "\n";
+            all_passed = false;
+        }
+    }
+
+    // 4. Print(std::ostream&) 的整条路径不分配, 输出与 operator<< 一致
+    {
+        std::cout << "Running SmallBuffer Tests4\n";
+        FixedStreambuf buf;
+        std::ostream stream(&buf);
+        Tools::Print(stream, Tools::Level::Normal, "warmup");
+        buf.Reset();
+        const std::string name = "player";
+        size_t count = CountAllocations([&]{
+            Tools::Print(stream, Tools::Level::Normal, name, " hp=", 97, " speed=", 1.25f, " alive=", true, ' ', 0.1);
+        });
+        if (count != 0 || buf.View() != "player hp=97 speed=1.25 alive=1 0.1\n") {
+            std::cerr << "Print allocated " << count << " times: " << buf.View() << "\n";
+            all_passed = false;
+        }
+    }
+
+#if defined(__cpp_lib_format)
+    // 5. Out() 可以作为 std::format_to 的输出迭代器
+    {
+        std::cout << "Running SmallBuffer Tests5\n";
+        Tools::SmallBuffer<> line;
+        size_t count = CountAllocations([&]{
+            std::format_to(line.Out(), "{}:{:>4}", "id", 7);
+        });
+        if (count != 0 || line.View() != "id:   7") {
+            std::cerr << "format_to allocated " << count << " times: " << line.View() << "\n";
+            all_passed = false;
+        }
+    }
+#endif
+
+    if (all_passed) {
+        std::cout << "All SmallBuffer tests passed!\n";
+    } else {
+        std::cout << "Some SmallBuffer tests FAILED!\n";
+    }
+    return all_passed;
+}